@@ -0,0 +1,91 @@
+#include <pebble.h>
+
+#include "Timr.h"
+#include "Agenda.h"
+#include "PowerStats.h"
+
+// Fails to compile if the book outgrows a single persist key
+typedef char agenda_book_fits_in_one_key[(sizeof(AgendaBook) <= PERSIST_DATA_MAX_LENGTH) ? 1 : -1];
+
+/*
+	Variables
+	========================================================================================
+*/
+// Used until agendas have been stored
+static const AgendaBook s_default_book = {
+	.version = AGENDA_VERSION,
+	.num_agendas = 3,
+	.agendas = {
+		{ "Talk + Q&A", 2, {
+			{ "Talk", 1200, 300, 120 },
+			{ "Q&A", 600, 0, 60 },
+		} },
+		{ "Workshop", 3, {
+			{ "Intro", 300, 0, 60 },
+			{ "Demo", 1800, 600, 300 },
+			{ "Q&A", 600, 0, 60 },
+		} },
+		{ "Lightning", 1, {
+			{ "Talk", 300, 60, 60 },
+		} },
+	},
+};
+
+static AgendaBook s_book;
+static bool s_loaded;
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+// Every agenda needs at least one segment and no more than fit, each of them
+// a duration the display can show
+static bool isValid(const AgendaBook *book){
+	if(book->version != AGENDA_VERSION || book->num_agendas > AGENDA_MAX)
+		return false;
+	
+	for(int i = 0; i < book->num_agendas; i++){
+		const Agenda *agenda = &book->agendas[i];
+		if(agenda->num_segments == 0 || agenda->num_segments > AGENDA_MAX_SEGMENTS)
+			return false;
+		
+		for(int j = 0; j < agenda->num_segments; j++){
+			uint16_t duration = agenda->segments[j].duration;
+			if(duration < AGENDA_MIN_DURATION || duration > AGENDA_MAX_DURATION)
+				return false;
+		}
+	}
+	
+	return true;
+}
+
+// Load every agenda with a single read the first time one is needed, falls back to the defaults
+static void loadBook(){
+	if(s_loaded)
+		return;
+	
+	s_loaded = true;
+	STATS_COUNT(STAT_PERSIST_READ);
+	int read = persist_read_data(AGENDA_BOOK, &s_book, sizeof(s_book));
+	
+	if(read != sizeof(s_book) || !isValid(&s_book))
+		s_book = s_default_book;
+}
+
+uint8_t agenda_count(){
+	loadBook();
+	return s_book.num_agendas;
+}
+
+// Agendas are selected from 1, AGENDA_NONE (or anything out of range) is no agenda
+const Agenda* agenda_get(uint8_t selected){
+	if(selected == AGENDA_NONE)
+		return NULL;
+	
+	loadBook();
+	if(selected > s_book.num_agendas)
+		return NULL;
+	
+	return &s_book.agendas[selected - 1];
+}
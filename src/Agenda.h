@@ -0,0 +1,49 @@
+/*
+ * Agenda.h
+ */
+
+#ifndef AGENDA_H_
+#define AGENDA_H_
+
+#include <pebble.h>
+
+#define AGENDA_VERSION 1
+
+// Sizes are picked so a full AgendaBook fits in one persist key
+#define AGENDA_MAX 3
+#define AGENDA_MAX_SEGMENTS 4
+#define AGENDA_NAME_LENGTH 12
+#define SEGMENT_NAME_LENGTH 8
+
+// Segment durations in seconds. The display shows at most 59:59.
+#define AGENDA_MIN_DURATION 1
+#define AGENDA_MAX_DURATION 3599
+
+// Selected agenda value for the plain single timer
+#define AGENDA_NONE 0
+
+// One section of a talk with its own cue settings
+typedef struct __attribute__((__packed__)) {
+	char name[SEGMENT_NAME_LENGTH];
+	uint16_t duration;
+	uint16_t interval_time;
+	uint16_t final_warning_time;
+} AgendaSegment;
+
+typedef struct __attribute__((__packed__)) {
+	char name[AGENDA_NAME_LENGTH];
+	uint8_t num_segments;
+	AgendaSegment segments[AGENDA_MAX_SEGMENTS];
+} Agenda;
+
+// Every agenda, stored as one blob
+typedef struct __attribute__((__packed__)) {
+	uint8_t version;
+	uint8_t num_agendas;
+	Agenda agendas[AGENDA_MAX];
+} AgendaBook;
+
+uint8_t agenda_count(void);
+const Agenda* agenda_get(uint8_t selected);
+
+#endif /* AGENDA_H_ */
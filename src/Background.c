@@ -0,0 +1,134 @@
+#include <pebble.h>
+
+#include "Timr.h"
+#include "Background.h"
+#include "WorkerProtocol.h"
+#include "PowerStats.h"
+
+/*
+	Variables
+	========================================================================================
+*/
+// What is in BACKGROUND_END_TIME, so a countdown handed back unchanged isn't rewritten
+static BackgroundState s_stored;
+static bool s_has_stored;
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+// The wakeup cookie holds the cue type and its remaining seconds, for telling wakeups apart.
+// The relaunched app works the cue out from the clock, like it does for the worker.
+#define COOKIE(type, remaining) ((int32_t) (remaining) << 8 | (type))
+
+// Start the worker on the stored state, false if it can't run.
+// Only one worker runs at a time, another app's may be in the way.
+static bool startWorker(const CueTimeline *timeline){
+	
+	// Nothing left to cue, in overtime for one
+	if(cues_peek(timeline) == NULL)
+		return false;
+	
+	switch(app_worker_launch()){
+		case APP_WORKER_RESULT_SUCCESS:
+			return true;
+		case APP_WORKER_RESULT_ALREADY_RUNNING:
+			app_worker_send_message(WORKER_RELOAD, &(AppWorkerMessage) { 0 });
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Schedule a wakeup for the next cue on the timeline that the system accepts,
+// false if none was. Only one is scheduled at a time, the relaunch schedules the one after.
+static bool scheduleNextCue(int64_t end_ms, int remaining, const CueTimeline *timeline){
+	
+	for(int i = timeline->next; i < timeline->count; i++){
+		const Cue *cue = &timeline->cues[i];
+		
+		if(cue->remaining >= remaining)
+			continue;
+		
+		time_t wake_time = (time_t) ((end_ms - (int64_t) cue->remaining * 1000 + 999) / 1000);
+		if(wake_time <= time(NULL))
+			wake_time = time(NULL) + 1;
+		
+		// Another app's wakeup may be too close, fall through to the next cue
+		if(wakeup_schedule(wake_time, COOKIE(cue->type, cue->remaining), false) >= 0)
+			return true;
+	}
+	return false;
+}
+
+// True if the app was opened only to play a cue, by a wakeup or the worker
+bool background_cue_launch(){
+	return launch_reason() == APP_LAUNCH_WAKEUP || launch_reason() == APP_LAUNCH_WORKER;
+}
+
+// Save a running countdown and hand its cues to the background so the app can close.
+// Wakeups cost nothing between cues, the worker stays in memory and wakes for each
+// cue as well, so it only takes over when no wakeup can be scheduled.
+void background_enter(const Countdown *countdown, const TimerState *timer, const CueTimeline *timeline){
+	
+	wakeup_cancel_all();
+	
+	// Nothing to store, and usually nothing to clear either
+	if(!countdown->running){
+		if(app_worker_is_running())
+			app_worker_kill();
+		
+		if(s_has_stored){
+			persist_delete(BACKGROUND_END_TIME);
+			STATS_COUNT(STAT_PERSIST_WRITE);
+		}
+		return;
+	}
+	
+	BackgroundState state = {
+		.end_ms = countdown->end_ms,
+		.segment = timer->segment,
+		.timer_start_time = timer->timer_start_time,
+		.interval_time = timer->interval_time,
+		.final_warning_time = timer->final_warning_time,
+	};
+	bool changed = !s_has_stored || memcmp(&state, &s_stored, sizeof(state)) != 0;
+	if(changed){
+		persist_write_data(BACKGROUND_END_TIME, &state, sizeof(state));
+		STATS_COUNT(STAT_PERSIST_WRITE);
+	}
+	
+	// Only a cue launch leaves the worker running. It still has every cue unless
+	// the launch moved the countdown on, to the next segment of an agenda say.
+	if(app_worker_is_running()){
+		if(changed)
+			app_worker_send_message(WORKER_RELOAD, &(AppWorkerMessage) { 0 });
+		return;
+	}
+	
+	if(!scheduleNextCue(countdown->end_ms, countdown_remaining(countdown), timeline))
+		startWorker(timeline);
+}
+
+// Pick a countdown left running in the background back up, it stays stored until
+// background_enter() knows whether it changed. Returns true if countdown was
+// restored, it may have run out while closed.
+bool background_restore(Countdown *countdown, uint8_t *segment){
+	
+	// Opened by the user, the foreground takes the cues over from the worker
+	if(!background_cue_launch() && app_worker_is_running())
+		app_worker_kill();
+	
+	wakeup_cancel_all();
+	
+	STATS_COUNT(STAT_PERSIST_READ);
+	if(persist_read_data(BACKGROUND_END_TIME, &s_stored, sizeof(s_stored)) != sizeof(s_stored))
+		return false;
+	
+	s_has_stored = true;
+	countdown->end_ms = s_stored.end_ms;
+	countdown->running = true;
+	*segment = s_stored.segment;
+	return true;
+}
@@ -0,0 +1,21 @@
+/*
+ * Background.h
+ */
+
+#ifndef BACKGROUND_H_
+#define BACKGROUND_H_
+
+#include <pebble.h>
+
+#include "Countdown.h"
+#include "Cues.h"
+#include "TimerCore.h"
+
+// Seconds a launch for a cue can trail it and still play it
+#define CUE_LAUNCH_LATE 2
+
+void background_enter(const Countdown *countdown, const TimerState *timer, const CueTimeline *timeline);
+bool background_restore(Countdown *countdown, uint8_t *segment);
+bool background_cue_launch(void);
+
+#endif /* BACKGROUND_H_ */
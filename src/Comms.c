@@ -0,0 +1,86 @@
+#include <pebble.h>
+
+#include "Comms.h"
+#include "PowerStats.h"
+
+/*
+	Variables
+	========================================================================================
+*/
+static CommsHandler s_handlers[NUM_COMMS_CHANNELS];
+
+// AppMessage is only opened when something is first sent
+static bool s_open;
+
+// Channel with a message in flight, -1 when the outbox is free
+static int8_t s_sending = -1;
+
+// Channels turned away while the outbox was busy
+static bool s_waiting[NUM_COMMS_CHANNELS];
+
+
+/*
+	Callbacks
+	========================================================================================
+*/
+// Tell the sender how it went, then let anyone waiting have a go
+static void finish(CommsResult result){
+	CommsChannel channel = s_sending;
+	s_sending = -1;
+	
+	if(s_handlers[channel])
+		s_handlers[channel](result);
+	
+	for(int i = 0; i < NUM_COMMS_CHANNELS && s_sending < 0; i++){
+		if(s_waiting[i]){
+			s_waiting[i] = false;
+			if(s_handlers[i])
+				s_handlers[i](COMMS_READY);
+		}
+	}
+}
+
+static void outbox_sent_handler(DictionaryIterator *iter, void *context){
+	if(s_sending >= 0)
+		finish(COMMS_SENT);
+}
+
+static void outbox_failed_handler(DictionaryIterator *iter, AppMessageResult reason, void *context){
+	APP_LOG(APP_LOG_LEVEL_WARNING, "Message %d failed: %d", s_sending, reason);
+	if(s_sending >= 0)
+		finish(COMMS_FAILED);
+}
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+void comms_set_handler(CommsChannel channel, CommsHandler handler){
+	s_handlers[channel] = handler;
+}
+
+// Start a message for the channel, NULL if one is already in flight.
+// The channel then gets COMMS_READY once the outbox is free.
+DictionaryIterator* comms_begin(CommsChannel channel){
+	if(!s_open){
+		app_message_register_outbox_sent(outbox_sent_handler);
+		app_message_register_outbox_failed(outbox_failed_handler);
+		app_message_open(APP_MESSAGE_INBOX_SIZE_MINIMUM, APP_MESSAGE_OUTBOX_SIZE_MINIMUM);
+		s_open = true;
+	}
+	
+	DictionaryIterator *iter;
+	if(s_sending >= 0 || app_message_outbox_begin(&iter) != APP_MSG_OK){
+		s_waiting[channel] = true;
+		return NULL;
+	}
+	
+	s_sending = channel;
+	return iter;
+}
+
+void comms_send(){
+	STATS_COUNT(STAT_MESSAGE);
+	app_message_outbox_send();
+}
@@ -0,0 +1,30 @@
+/*
+ * Comms.h
+ */
+
+#ifndef COMMS_H_
+#define COMMS_H_
+
+#include <pebble.h>
+
+// Everything that talks to the phone, they share one outbox
+typedef enum {
+	COMMS_SESSION_LOG,
+	COMMS_PRESENTER,
+	NUM_COMMS_CHANNELS
+} CommsChannel;
+
+// How a message went, or that the outbox is free again after being turned away
+typedef enum {
+	COMMS_SENT,
+	COMMS_FAILED,
+	COMMS_READY
+} CommsResult;
+
+typedef void (*CommsHandler)(CommsResult result);
+
+void comms_set_handler(CommsChannel channel, CommsHandler handler);
+DictionaryIterator* comms_begin(CommsChannel channel);
+void comms_send(void);
+
+#endif /* COMMS_H_ */
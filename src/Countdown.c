@@ -0,0 +1,70 @@
+#include "Platform.h"
+
+#include "Countdown.h"
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+// Wall clock time in milliseconds
+int64_t countdown_now_ms(){
+	time_t seconds;
+	uint16_t milliseconds;
+	time_ms(&seconds, &milliseconds);
+	return (int64_t) seconds * 1000 + milliseconds;
+}
+
+// Stop and load a new duration
+void countdown_reset(Countdown *countdown, uint16_t seconds){
+	countdown->running = false;
+	countdown->end_ms = 0;
+	countdown->remaining_ms = (int32_t) seconds * 1000;
+}
+
+// Anchor the end time to now plus whatever was left
+void countdown_start(Countdown *countdown){
+	if(countdown->running)
+		return;
+	
+	countdown->end_ms = countdown_now_ms() + countdown->remaining_ms;
+	countdown->running = true;
+}
+
+// Freeze the remaining time, the anchor is rebuilt on the next start
+void countdown_pause(Countdown *countdown){
+	if(!countdown->running)
+		return;
+	
+	countdown->remaining_ms = countdown_remaining_ms(countdown);
+	countdown->running = false;
+}
+
+// Follow on with another duration from where this one ended, so no time is lost in between
+void countdown_chain(Countdown *countdown, uint16_t seconds){
+	if(countdown->running)
+		countdown->end_ms += (int64_t) seconds * 1000;
+	else
+		countdown->remaining_ms = (int32_t) seconds * 1000;
+}
+
+int32_t countdown_remaining_ms(const Countdown *countdown){
+	if(!countdown->running)
+		return countdown->remaining_ms;
+	
+	int64_t remaining = countdown->end_ms - countdown_now_ms();
+	return remaining > 0 ? (int32_t) remaining : 0;
+}
+
+// Whole seconds left, rounded up so the display starts on the full time
+int countdown_remaining(const Countdown *countdown){
+	return (countdown_remaining_ms(countdown) + 999) / 1000;
+}
+
+// How far past the end a running countdown is, zero until it gets there
+int32_t countdown_overtime_ms(const Countdown *countdown){
+	if(!countdown->running)
+		return 0;
+	
+	int64_t overtime = countdown_now_ms() - countdown->end_ms;
+	return overtime > 0 ? (int32_t) overtime : 0;
+}
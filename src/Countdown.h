@@ -0,0 +1,28 @@
+/*
+ * Countdown.h
+ */
+
+#ifndef COUNTDOWN_H_
+#define COUNTDOWN_H_
+
+#include "Platform.h"
+
+// A countdown anchored to the wall clock. While running only the end
+// time is stored, remaining time is worked out when it is asked for.
+typedef struct {
+	bool running;
+	int64_t end_ms;        // Wall clock end time, valid while running
+	int32_t remaining_ms;  // Frozen remaining time, valid while paused
+} Countdown;
+
+int64_t countdown_now_ms(void);
+
+void countdown_reset(Countdown *countdown, uint16_t seconds);
+void countdown_start(Countdown *countdown);
+void countdown_pause(Countdown *countdown);
+void countdown_chain(Countdown *countdown, uint16_t seconds);
+int32_t countdown_remaining_ms(const Countdown *countdown);
+int countdown_remaining(const Countdown *countdown);
+int32_t countdown_overtime_ms(const Countdown *countdown);
+
+#endif /* COUNTDOWN_H_ */
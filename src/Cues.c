@@ -0,0 +1,111 @@
+#include "Platform.h"
+
+#include "Cues.h"
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+static void addCue(CueTimeline *timeline, uint16_t remaining, CueType type){
+	timeline->cues[timeline->count].remaining = remaining;
+	timeline->cues[timeline->count].type = type;
+	timeline->count++;
+}
+
+// Work out every cue of a countdown once, called when the settings change.
+// An interval of 0 means no interval cues.
+void cues_build(CueTimeline *timeline, uint16_t start_time, uint16_t interval_time, uint16_t final_warning_time){
+	
+	timeline->count = 0;
+	timeline->next = 0;
+	
+	// Interval cues are strictly below the start time
+	uint16_t last = start_time > 0 ? start_time - 1 : 0;
+	
+	// Spread the interval cues out if there are too many to hold,
+	// leaving room for the final warning, last ten seconds and time up
+	uint16_t step = interval_time;
+	if(step > 0){
+		uint16_t num_intervals = last / step;
+		if(num_intervals > CUE_MAX - 3)
+			step *= (num_intervals + CUE_MAX - 4) / (CUE_MAX - 3);
+	}
+	
+	// A final warning on the last ten seconds goes a second early so both are felt
+	if(final_warning_time == LAST_TEN_TIME && start_time > LAST_TEN_TIME)
+		final_warning_time++;
+	
+	bool has_final_warning = final_warning_time > 0 && final_warning_time < start_time;
+	uint16_t interval_cue = step > 0 ? (last / step) * step : 0;
+	
+	// Merge intervals and the final warning, largest remaining time first
+	while(interval_cue > 0 || has_final_warning){
+		
+		if(has_final_warning && final_warning_time >= interval_cue){
+			
+			// Final warning replaces an interval cue at the same time
+			if(final_warning_time == interval_cue)
+				interval_cue -= step;
+			
+			addCue(timeline, final_warning_time, CUE_FINAL_WARNING);
+			has_final_warning = false;
+		}else{
+			addCue(timeline, interval_cue, CUE_INTERVAL);
+			interval_cue -= step;
+		}
+	}
+	
+	// Last ten seconds goes in order, replacing an interval at the same time
+	if(start_time > LAST_TEN_TIME){
+		uint8_t i = timeline->count;
+		while(i > 0 && timeline->cues[i - 1].remaining <= LAST_TEN_TIME)
+			i--;
+		
+		if(i < timeline->count && timeline->cues[i].remaining == LAST_TEN_TIME){
+			timeline->cues[i].type = CUE_LAST_TEN;
+		}else{
+			memmove(&timeline->cues[i + 1], &timeline->cues[i], (timeline->count - i) * sizeof(Cue));
+			timeline->cues[i].remaining = LAST_TEN_TIME;
+			timeline->cues[i].type = CUE_LAST_TEN;
+			timeline->count++;
+		}
+	}
+	
+	addCue(timeline, 0, CUE_TIME_UP);
+}
+
+// Skip every cue at or above remaining, used when (re)starting from a time
+void cues_seek(CueTimeline *timeline, int remaining){
+	timeline->next = 0;
+	while(timeline->next < timeline->count && timeline->cues[timeline->next].remaining >= remaining)
+		timeline->next++;
+}
+
+// The next cue to fire, NULL once time up has fired
+const Cue* cues_peek(const CueTimeline *timeline){
+	return timeline->next < timeline->count ? &timeline->cues[timeline->next] : NULL;
+}
+
+// Step past every cue reached at remaining and return the strongest one
+CueType cues_advance(CueTimeline *timeline, int remaining){
+	CueType type = CUE_NONE;
+	
+	while(timeline->next < timeline->count && timeline->cues[timeline->next].remaining >= remaining){
+		if(timeline->cues[timeline->next].type > type)
+			type = timeline->cues[timeline->next].type;
+		timeline->next++;
+	}
+	
+	return type;
+}
+
+// How long until the next cue fires, -1 if there is none
+int32_t cues_ms_until_next(const CueTimeline *timeline, int32_t remaining_ms){
+	const Cue *cue = cues_peek(timeline);
+	
+	if(cue == NULL)
+		return -1;
+	
+	int32_t ms = remaining_ms - (int32_t) cue->remaining * 1000;
+	return ms > 0 ? ms : 0;
+}
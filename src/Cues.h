@@ -0,0 +1,51 @@
+/*
+ * Cues.h
+ */
+
+#ifndef CUES_H_
+#define CUES_H_
+
+#include "Platform.h"
+
+// Most entries a timeline holds, interval cues are spread out to fit
+#define CUE_MAX 64
+
+// Seconds left for the last ten seconds cue
+#define LAST_TEN_TIME 10
+
+// Interval cues get stronger once this few seconds are left
+#define INTERVAL_STRONG_TIME 300
+
+// Seconds between cues once the time is up and the timer counts on
+#define OVERTIME_CUE_TIME 60
+
+// Cue types, higher values win when several are passed at once
+typedef enum {
+	CUE_NONE = 0,
+	CUE_INTERVAL,
+	CUE_FINAL_WARNING,
+	CUE_LAST_TEN,
+	CUE_TIME_UP,
+	CUE_OVERTIME
+} CueType;
+
+// Fire type when the remaining seconds reach remaining
+typedef struct {
+	uint16_t remaining;
+	uint8_t type;
+} Cue;
+
+// Cues sorted by remaining seconds, largest first
+typedef struct {
+	Cue cues[CUE_MAX];
+	uint8_t count;
+	uint8_t next;
+} CueTimeline;
+
+void cues_build(CueTimeline *timeline, uint16_t start_time, uint16_t interval_time, uint16_t final_warning_time);
+void cues_seek(CueTimeline *timeline, int remaining);
+const Cue* cues_peek(const CueTimeline *timeline);
+CueType cues_advance(CueTimeline *timeline, int remaining);
+int32_t cues_ms_until_next(const CueTimeline *timeline, int32_t remaining_ms);
+
+#endif /* CUES_H_ */
@@ -0,0 +1,170 @@
+#include <pebble.h>
+
+#include "DigitLayer.h"
+#include "PowerStats.h"
+#include "Profiler.h"
+
+/*
+	Definitions
+	========================================================================================
+*/
+#define NUM_DIGITS 4
+#define NUM_SEGMENTS 7
+
+// Value that draws nothing, used for the leading digit
+#define DIGIT_BLANK 10
+
+// Segment stroke widths
+#define BOLD_STROKE 6
+#define LIGHT_STROKE 3
+
+// Segment rectangles for a stroke width, in a,b,c,d,e,f,g order
+#define SEGMENTS(t) { \
+	{ { (t), 0 }, { DIGIT_WIDTH - 2 * (t), (t) } }, \
+	{ { DIGIT_WIDTH - (t), (t) }, { (t), DIGIT_HEIGHT / 2 - (t) } }, \
+	{ { DIGIT_WIDTH - (t), DIGIT_HEIGHT / 2 }, { (t), DIGIT_HEIGHT / 2 - (t) } }, \
+	{ { (t), DIGIT_HEIGHT - (t) }, { DIGIT_WIDTH - 2 * (t), (t) } }, \
+	{ { 0, DIGIT_HEIGHT / 2 }, { (t), DIGIT_HEIGHT / 2 - (t) } }, \
+	{ { 0, (t) }, { (t), DIGIT_HEIGHT / 2 - (t) } }, \
+	{ { (t), DIGIT_HEIGHT / 2 - (t) / 2 }, { DIGIT_WIDTH - 2 * (t), (t) } }, \
+}
+
+
+/*
+	Glyph Tables
+	========================================================================================
+*/
+// Which segments each digit lights, bit 0 is segment a
+static const uint8_t s_glyphs[DIGIT_BLANK + 1] = {
+	0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F, 0x00
+};
+
+// Minutes are drawn bold and seconds light, like the old fonts
+static const GRect s_bold_segments[NUM_SEGMENTS] = SEGMENTS(BOLD_STROKE);
+static const GRect s_light_segments[NUM_SEGMENTS] = SEGMENTS(LIGHT_STROKE);
+
+
+/*
+	Variables
+	========================================================================================
+*/
+// Data of the digit layer, digits are minute tens, minute ones, second tens, second ones
+typedef struct {
+	uint8_t values[NUM_DIGITS];
+	GPoint origins[NUM_DIGITS];
+	int8_t highlight;
+} DigitLayerData;
+
+
+/*
+	Drawing
+	========================================================================================
+*/
+// The highlighted row's background, then every digit on top of it
+static void digit_layer_update_proc(Layer *layer, GContext *ctx){
+	DigitLayerData *data = layer_get_data(layer);
+	
+	// The digits are the first thing drawn after launch
+	PROFILE_FIRST_FRAME();
+	
+	if(data->highlight != DIGIT_ROW_NONE){
+		GRect bounds = layer_get_bounds(layer);
+		if(data->highlight != DIGIT_ROW_ALL){
+			bounds.origin.y = data->highlight * (bounds.size.h / 2);
+			bounds.size.h /= 2;
+		}
+		
+		graphics_context_set_fill_color(ctx, GColorBlack);
+		graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+	}
+	
+	for(int i = 0; i < NUM_DIGITS; i++){
+		uint8_t glyph = s_glyphs[data->values[i]];
+		const GRect *segments = (i < 2) ? s_bold_segments : s_light_segments;
+		bool inverted = data->highlight == DIGIT_ROW_ALL || (i / 2) == data->highlight;
+		
+		graphics_context_set_fill_color(ctx, inverted ? GColorWhite : GColorBlack);
+		for(int j = 0; j < NUM_SEGMENTS; j++){
+			if(!(glyph & (1 << j)))
+				continue;
+			
+			GRect segment = segments[j];
+			segment.origin.x += data->origins[i].x;
+			segment.origin.y += data->origins[i].y;
+			graphics_fill_rect(ctx, segment, 0, GCornerNone);
+		}
+	}
+}
+
+// Change one digit, returns true if it shows something new
+static bool setDigit(DigitLayerData *data, int digit, uint8_t value){
+	if(data->values[digit] == value)
+		return false;
+	
+	data->values[digit] = value;
+	return true;
+}
+
+
+/*
+	Create and Destroy
+	========================================================================================
+*/
+// Digits are right aligned, right_inset pixels in from the right edge
+DigitLayer* digit_layer_create(GRect frame, int16_t right_inset){
+	
+	DigitLayer *digit_layer = layer_create_with_data(frame, sizeof(DigitLayerData));
+	DigitLayerData *data = layer_get_data(digit_layer);
+	data->highlight = DIGIT_ROW_NONE;
+	layer_set_update_proc(digit_layer, digit_layer_update_proc);
+	
+	// Two right aligned rows, each centered in its half
+	int16_t right = frame.size.w - right_inset - DIGIT_WIDTH;
+	int16_t row_offset = (frame.size.h / 2 - DIGIT_HEIGHT) / 2;
+	
+	for(int i = 0; i < NUM_DIGITS; i++){
+		data->values[i] = DIGIT_BLANK;
+		data->origins[i].x = right - ((i % 2) == 0 ? DIGIT_WIDTH + DIGIT_SPACING : 0);
+		data->origins[i].y = (i / 2) * (frame.size.h / 2) + row_offset;
+	}
+	
+	return digit_layer;
+}
+
+void digit_layer_destroy(DigitLayer *digit_layer){
+	layer_destroy(digit_layer);
+}
+
+Layer* digit_layer_get_layer(DigitLayer *digit_layer){
+	return digit_layer;
+}
+
+// Show a time, the tens digit is left blank below ten like "%d" did.
+// DIGIT_HIDDEN seconds leave the bottom row empty. Nothing is marked dirty
+// unless a digit actually changes.
+void digit_layer_set_time(DigitLayer *digit_layer, int minutes, int seconds){
+	DigitLayerData *data = layer_get_data(digit_layer);
+	bool changed = false;
+	
+	changed |= setDigit(data, 0, minutes >= 10 ? minutes / 10 : DIGIT_BLANK);
+	changed |= setDigit(data, 1, minutes % 10);
+	changed |= setDigit(data, 2, seconds >= 10 ? seconds / 10 : DIGIT_BLANK);
+	changed |= setDigit(data, 3, seconds >= 0 ? seconds % 10 : DIGIT_BLANK);
+	
+	if(changed){
+		layer_mark_dirty(digit_layer);
+		STATS_COUNT(STAT_LAYER_DIRTY);
+	}
+}
+
+// Draw one row white on black, DIGIT_ROW_NONE for neither or DIGIT_ROW_ALL for both
+void digit_layer_set_highlight(DigitLayer *digit_layer, int8_t row){
+	DigitLayerData *data = layer_get_data(digit_layer);
+	
+	if(data->highlight == row)
+		return;
+	
+	data->highlight = row;
+	layer_mark_dirty(digit_layer);
+	STATS_COUNT(STAT_LAYER_DIRTY);
+}
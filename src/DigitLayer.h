@@ -0,0 +1,33 @@
+/*
+ * DigitLayer.h
+ */
+
+#ifndef DIGITLAYER_H_
+#define DIGITLAYER_H_
+
+#include <pebble.h>
+
+// Size of one digit glyph
+#define DIGIT_WIDTH 24
+#define DIGIT_HEIGHT 42
+#define DIGIT_SPACING 4
+
+// Rows that can be highlighted
+#define DIGIT_ROW_NONE -1
+#define DIGIT_ROW_MINUTES 0
+#define DIGIT_ROW_SECONDS 1
+#define DIGIT_ROW_ALL 2
+
+// Pass as the seconds to leave the seconds row empty
+#define DIGIT_HIDDEN -1
+
+// Minutes over seconds, drawn from a seven segment glyph table
+typedef Layer DigitLayer;
+
+DigitLayer* digit_layer_create(GRect frame, int16_t right_inset);
+void digit_layer_destroy(DigitLayer *digit_layer);
+Layer* digit_layer_get_layer(DigitLayer *digit_layer);
+void digit_layer_set_time(DigitLayer *digit_layer, int minutes, int seconds);
+void digit_layer_set_highlight(DigitLayer *digit_layer, int8_t row);
+
+#endif /* DIGITLAYER_H_ */
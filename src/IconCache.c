@@ -0,0 +1,85 @@
+#include <pebble.h>
+
+#include "IconCache.h"
+
+/*
+	Variables
+	========================================================================================
+*/
+typedef struct {
+	uint32_t resource_id;
+	GBitmap *bitmap;
+	uint16_t refcount;
+	uint16_t bytes;
+} IconEntry;
+
+// Loaded icons, an entry is free when its bitmap is NULL
+static IconEntry s_icons[ICON_CACHE_SIZE];
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+static IconEntry* findIcon(uint32_t resource_id){
+	for(int i = 0; i < ICON_CACHE_SIZE; i++){
+		if(s_icons[i].bitmap && s_icons[i].resource_id == resource_id)
+			return &s_icons[i];
+	}
+	return NULL;
+}
+
+// Hand out a shared bitmap, it is only loaded the first time it is asked for
+GBitmap* icon_cache_acquire(uint32_t resource_id){
+	
+	IconEntry *entry = findIcon(resource_id);
+	if(entry){
+		entry->refcount++;
+		return entry->bitmap;
+	}
+	
+	// Take a free entry
+	for(int i = 0; entry == NULL && i < ICON_CACHE_SIZE; i++){
+		if(s_icons[i].bitmap == NULL)
+			entry = &s_icons[i];
+	}
+	
+	if(entry == NULL){
+		APP_LOG(APP_LOG_LEVEL_ERROR, "Icon cache full, can't load %d", (int) resource_id);
+		return NULL;
+	}
+	
+	entry->bitmap = gbitmap_create_with_resource(resource_id);
+	if(entry->bitmap == NULL)
+		return NULL;
+	
+	entry->resource_id = resource_id;
+	entry->refcount = 1;
+	entry->bytes = gbitmap_get_bytes_per_row(entry->bitmap) * gbitmap_get_bounds(entry->bitmap).size.h;
+	return entry->bitmap;
+}
+
+// Give a bitmap back, the last release frees it
+void icon_cache_release(uint32_t resource_id){
+	
+	IconEntry *entry = findIcon(resource_id);
+	if(entry == NULL)
+		return;
+	
+	if(--entry->refcount == 0){
+		gbitmap_destroy(entry->bitmap);
+		entry->bitmap = NULL;
+	}
+}
+
+// Pixel bytes held by every loaded icon
+size_t icon_cache_heap_bytes(){
+	size_t bytes = 0;
+	
+	for(int i = 0; i < ICON_CACHE_SIZE; i++){
+		if(s_icons[i].bitmap)
+			bytes += s_icons[i].bytes;
+	}
+	
+	return bytes;
+}
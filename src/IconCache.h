@@ -0,0 +1,17 @@
+/*
+ * IconCache.h
+ */
+
+#ifndef ICONCACHE_H_
+#define ICONCACHE_H_
+
+#include <pebble.h>
+
+// Most distinct icons loaded at the same time
+#define ICON_CACHE_SIZE 8
+
+GBitmap* icon_cache_acquire(uint32_t resource_id);
+void icon_cache_release(uint32_t resource_id);
+size_t icon_cache_heap_bytes(void);
+
+#endif /* ICONCACHE_H_ */
@@ -0,0 +1,30 @@
+/*
+ * Layout.h
+ */
+
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include <pebble.h>
+
+// The build defines these for each platform from the LAYOUTS table in wscript,
+// the fallback is the rectangular 144x168 screen
+#ifndef LAYOUT_DIGIT_X
+#define LAYOUT_DIGIT_X 0
+#define LAYOUT_DIGIT_Y 0
+#define LAYOUT_DIGIT_W 144
+#define LAYOUT_DIGIT_H 168
+#define LAYOUT_DIGIT_INSET 40
+#define LAYOUT_PROGRESS_X 4
+#define LAYOUT_PROGRESS_Y 4
+#define LAYOUT_PROGRESS_W 12
+#define LAYOUT_PROGRESS_H 160
+#endif
+
+// Where the minutes over seconds go, the inset keeps them clear of the action bar
+#define LAYOUT_DIGIT_FRAME GRect(LAYOUT_DIGIT_X, LAYOUT_DIGIT_Y, LAYOUT_DIGIT_W, LAYOUT_DIGIT_H)
+
+// Where the progress bar or ring goes
+#define LAYOUT_PROGRESS_FRAME GRect(LAYOUT_PROGRESS_X, LAYOUT_PROGRESS_Y, LAYOUT_PROGRESS_W, LAYOUT_PROGRESS_H)
+
+#endif /* LAYOUT_H_ */
@@ -2,13 +2,28 @@
 	
 #include "Timr.h"
 #include "MenuWindow.h"
+#include "Settings.h"
+#include "Agenda.h"
+#include "Presets.h"
+#include "SessionLog.h"
+#include "Profiler.h"
 	
 /*
 	Definitions
 	========================================================================================
 */
-#define NUM_MENU_SECTIONS 1
-#define NUM_MENU_ITEMS 3
+#define NUM_MENU_SECTIONS 3
+// The profiler row is only there in profiling builds
+#ifdef TIMR_PROFILE
+#define NUM_MENU_ITEMS 5
+#else
+#define NUM_MENU_ITEMS 4
+#endif
+
+// Sections
+#define SETTINGS_SECTION 0
+#define PRESET_SECTION 1
+#define AGENDA_SECTION 2
 	
 
 /*
@@ -37,9 +52,80 @@ static uint16_t menu_get_num_sections_callback(MenuLayer *menu_layer, void *data
 }
 
 static uint16_t menu_get_num_rows_callback(MenuLayer *menu_layer, uint16_t section_index, void *data) {
+	
+	// The single timer, then every agenda
+	if(section_index == AGENDA_SECTION)
+		return agenda_count() + 1;
+	
+	if(section_index == PRESET_SECTION)
+		return preset_count();
+	
   return NUM_MENU_ITEMS;
 }
 
+static int16_t menu_get_header_height_callback(MenuLayer *menu_layer, uint16_t section_index, void *data) {
+  return MENU_CELL_BASIC_HEADER_HEIGHT;
+}
+
+static void menu_draw_header_callback(GContext* ctx, const Layer *cell_layer, uint16_t section_index, void *data) {
+  switch (section_index) {
+    case SETTINGS_SECTION:
+      menu_cell_basic_header_draw(ctx, cell_layer, "Timer");
+      break;
+    case PRESET_SECTION:
+      menu_cell_basic_header_draw(ctx, cell_layer, "Presets");
+      break;
+    case AGENDA_SECTION:
+      menu_cell_basic_header_draw(ctx, cell_layer, "Agenda");
+      break;
+  }
+}
+
+// Preset rows, presets are selected from 1
+static void draw_preset_row(GContext* ctx, const Layer *cell_layer, uint16_t row) {
+	
+	static char s_subtitle[16];
+	const TimrSettings *settings = settings_get();
+	const Preset *preset = preset_get(row + 1);
+	
+	if(settings->agenda == AGENDA_NONE && settings->preset == row + 1)
+		snprintf(s_subtitle, sizeof(s_subtitle), "Selected");
+	else
+		snprintf(s_subtitle, sizeof(s_subtitle), "%d:%02d", preset->timer_start_time / 60, preset->timer_start_time % 60);
+	
+	menu_cell_basic_draw(ctx, cell_layer, preset->name, s_subtitle, NULL);
+}
+
+// Segment names in order, like "Intro, Demo, Q&A". Names fill their field
+// without a terminator when they are full length.
+static void formatSegments(char *buffer, size_t size, const Agenda *agenda){
+	size_t length = 0;
+	buffer[0] = '\0';
+	
+	for(int i = 0; i < agenda->num_segments && length < size; i++){
+		length += snprintf(buffer + length, size - length, "%s%.*s", i > 0 ? ", " : "",
+			SEGMENT_NAME_LENGTH, agenda->segments[i].name);
+	}
+}
+
+// Agenda rows, row 0 is the single timer
+static void draw_agenda_row(GContext* ctx, const Layer *cell_layer, uint16_t row) {
+	
+	static char s_subtitle[AGENDA_MAX_SEGMENTS * (SEGMENT_NAME_LENGTH + 2)];
+	const Agenda *agenda = agenda_get(row);
+	
+	const TimrSettings *settings = settings_get();
+	
+	if(row == settings->agenda && (agenda || settings->preset == PRESET_NONE))
+		snprintf(s_subtitle, sizeof(s_subtitle), "Selected");
+	else if(agenda)
+		formatSegments(s_subtitle, sizeof(s_subtitle), agenda);
+	else
+		snprintf(s_subtitle, sizeof(s_subtitle), "Settings above");
+	
+	menu_cell_basic_draw(ctx, cell_layer, agenda ? agenda->name : "Single timer", s_subtitle, NULL);
+}
+
 static void menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data) {
 	
   // Determine which section we're going to draw in
@@ -58,13 +144,43 @@ static void menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuI
         case 2: 
           menu_cell_basic_draw(ctx, cell_layer, "Final Warning", "Vibrate twice at time", NULL);
           break;
+        case 3:
+          menu_cell_basic_draw(ctx, cell_layer, "Send Log", "Sessions to phone", NULL);
+          break;
+        case 4:
+          menu_cell_basic_draw(ctx, cell_layer, "Profiler", "Debug timings", NULL);
+          break;
       }
       break;
+    case PRESET_SECTION:
+      draw_preset_row(ctx, cell_layer, cell_index->row);
+      break;
+    case AGENDA_SECTION:
+      draw_agenda_row(ctx, cell_layer, cell_index->row);
+      break;
   }
 }
 
 static void menu_select_callback(MenuLayer *menu_layer, MenuIndex *cell_index, void *data) {
 	
+	// Picking an agenda, the timer window picks it up through the settings.
+	// The single timer goes back to the times set above.
+	if(cell_index->section == AGENDA_SECTION){
+		settings_set(AGENDA_SELECTED, cell_index->row);
+		if(cell_index->row == AGENDA_NONE)
+			settings_set(PRESET_SELECTED, PRESET_NONE);
+		menu_layer_reload_data(menu_layer);
+		return;
+	}
+	
+	// Picking a preset is only an index change, the times are already in the table
+	if(cell_index->section == PRESET_SECTION){
+		settings_set(AGENDA_SELECTED, AGENDA_NONE);
+		settings_set(PRESET_SELECTED, cell_index->row + 1);
+		menu_layer_reload_data(menu_layer);
+		return;
+	}
+	
   // Use the row to specify which item will receive the select action
   switch (cell_index->row) {
     // This is the menu item with the cycling icon
@@ -77,6 +193,12 @@ static void menu_select_callback(MenuLayer *menu_layer, MenuIndex *cell_index, v
     case 2:
 			switchWindow(SET_FINAL_WARNING_WINDOW);
       break;
+    case 3:
+			session_log_export();
+      break;
+    case 4:
+			switchWindow(DEBUG_WINDOW);
+      break;
   }
 
 }
@@ -86,7 +208,9 @@ static void menu_select_callback(MenuLayer *menu_layer, MenuIndex *cell_index, v
 	Load and Unload Definitions
 	========================================================================================
 */
-static void main_window_load(Window *window) {
+// Build the menu, only done the first time the window is needed
+static void buildWindow(Window *window) {
+	PROFILE_BEGIN(PROFILE_WINDOW_LOAD);
 	
   // Now we prepare to initialize the menu layer
   window_layer = window_get_root_layer(window);
@@ -97,6 +221,8 @@ static void main_window_load(Window *window) {
   menu_layer_set_callbacks(s_menu_layer, NULL, (MenuLayerCallbacks){
     .get_num_sections = menu_get_num_sections_callback,
     .get_num_rows = menu_get_num_rows_callback,
+    .get_header_height = menu_get_header_height_callback,
+    .draw_header = menu_draw_header_callback,
     .draw_row = menu_draw_row_callback,
     .select_click = menu_select_callback,
   });
@@ -105,11 +231,7 @@ static void main_window_load(Window *window) {
   menu_layer_set_click_config_onto_window(s_menu_layer, window);
 
   layer_add_child(window_layer, menu_layer_get_layer(s_menu_layer));
-}
-
-static void main_window_unload(Window *window) {
-  // Destroy the menu layer
-  menu_layer_destroy(s_menu_layer);
+	PROFILE_END();
 }
 
 
@@ -117,16 +239,23 @@ static void main_window_unload(Window *window) {
 	Window Initiation
 	========================================================================================
 */
-void menu_window_init() {
-  s_main_window = window_create();
-  window_set_window_handlers(s_main_window, (WindowHandlers) {
-    .load = main_window_load,
-    .unload = main_window_unload,
-  });
-  window_stack_push(s_main_window, true);
+// The window is created once and kept across pushes, only its rows are reloaded
+Window* menu_window_get() {
+	
+	if(s_main_window == NULL){
+  	s_main_window = window_create();
+		buildWindow(s_main_window);
+	}
+	
+	menu_layer_reload_data(s_menu_layer);
+	return s_main_window;
 }
 
-void deinit() {
+void menu_window_deinit() {
+	if(s_main_window == NULL)
+		return;
+	
+  menu_layer_destroy(s_menu_layer);
   window_destroy(s_main_window);
+	s_main_window = NULL;
 }
-
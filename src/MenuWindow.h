@@ -7,7 +7,8 @@
 #ifndef MENU_H_
 #define MENU_H_
 
-void menu_window_init(void);
+Window* menu_window_get(void);
+void menu_window_deinit(void);
 
 
 #endif /* MENU_H_ */
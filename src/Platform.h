@@ -0,0 +1,15 @@
+/*
+ * Platform.h
+ */
+
+#ifndef PLATFORM_H_
+#define PLATFORM_H_
+
+// Countdown and Cues are built into the worker too, which has its own SDK header
+#ifdef TIMR_WORKER
+#include <pebble_worker.h>
+#else
+#include <pebble.h>
+#endif
+
+#endif /* PLATFORM_H_ */
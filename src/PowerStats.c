@@ -0,0 +1,91 @@
+#include <pebble.h>
+
+#include "PowerStats.h"
+#include "IconCache.h"
+#include "Storage.h"
+
+#ifdef TIMR_POWER_STATS
+
+/*
+	Variables
+	========================================================================================
+*/
+static uint32_t s_counts[NUM_STATS];
+static size_t s_heap_high_water;
+static time_t s_session_start;
+
+static const char *s_stat_names[NUM_STATS] = {
+	"wakeups",
+	"persist reads",
+	"persist writes",
+	"layer dirties",
+	"vibes",
+	"messages sent",
+};
+
+// Budgets in PowerStat order, a base and a rate per minute
+static const uint32_t s_budgets[NUM_STATS][2] = {
+	{ BUDGET_WAKEUPS, BUDGET_WAKEUPS_PER_MIN },
+	{ BUDGET_PERSIST_READS, BUDGET_PERSIST_READS_PER_MIN },
+	{ BUDGET_PERSIST_WRITES, BUDGET_PERSIST_WRITES_PER_MIN },
+	{ BUDGET_LAYER_DIRTIES, BUDGET_LAYER_DIRTIES_PER_MIN },
+	{ BUDGET_VIBES, BUDGET_VIBES_PER_MIN },
+	{ BUDGET_MESSAGES, BUDGET_MESSAGES_PER_MIN },
+};
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+void power_stats_init(){
+	memset(s_counts, 0, sizeof(s_counts));
+	s_heap_high_water = heap_bytes_used();
+	s_session_start = time(NULL);
+}
+
+void power_stats_count(PowerStat stat){
+	s_counts[stat]++;
+}
+
+void power_stats_sample_heap(){
+	size_t used = heap_bytes_used();
+	if(used > s_heap_high_water)
+		s_heap_high_water = used;
+}
+
+// What stat may reach in a session open for minutes
+uint32_t power_stats_budget(PowerStat stat, uint32_t minutes){
+	return s_budgets[stat][0] + s_budgets[stat][1] * minutes;
+}
+
+// Log every count against its budget, returns false if any went over
+bool power_stats_report(){
+	
+	// Rates are rounded up to whole minutes so short sessions aren't penalised
+	uint32_t minutes = (time(NULL) - s_session_start + 59) / 60;
+	if(minutes == 0)
+		minutes = 1;
+	
+	bool within_budget = true;
+	
+	for(int i = 0; i < NUM_STATS; i++){
+		uint32_t budget = power_stats_budget(i, minutes);
+		bool over = s_counts[i] > budget;
+		
+		APP_LOG(over ? APP_LOG_LEVEL_WARNING : APP_LOG_LEVEL_INFO, "%s: %d / %d%s",
+			s_stat_names[i], (int) s_counts[i], (int) budget, over ? " OVER BUDGET" : "");
+		within_budget = within_budget && !over;
+	}
+	
+	power_stats_sample_heap();
+	bool heap_over = s_heap_high_water > BUDGET_HEAP_BYTES;
+	APP_LOG(heap_over ? APP_LOG_LEVEL_WARNING : APP_LOG_LEVEL_INFO, "heap high water: %d / %d%s",
+		(int) s_heap_high_water, BUDGET_HEAP_BYTES, heap_over ? " OVER BUDGET" : "");
+	APP_LOG(APP_LOG_LEVEL_INFO, "icons still loaded: %d bytes", (int) icon_cache_heap_bytes());
+	APP_LOG(APP_LOG_LEVEL_INFO, "settings record writes, lifetime: %d", (int) storage_write_count());
+	
+	return within_budget && !heap_over;
+}
+
+#endif /* TIMR_POWER_STATS */
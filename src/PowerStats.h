@@ -0,0 +1,61 @@
+/*
+ * PowerStats.h
+ */
+
+#ifndef POWERSTATS_H_
+#define POWERSTATS_H_
+
+#include <pebble.h>
+
+// Power proxies counted over a session
+typedef enum {
+	STAT_WAKEUP,
+	STAT_PERSIST_READ,
+	STAT_PERSIST_WRITE,
+	STAT_LAYER_DIRTY,
+	STAT_VIBE,
+	STAT_MESSAGE,
+	NUM_STATS
+} PowerStat;
+
+// Budgets, checked in so a change that costs more power shows up in the log.
+// Each is a base per session plus a rate per minute the app is open. The base
+// pays for the last five minutes, where the seconds tick; the rates only leave
+// room for cues and minute changes, so ticking every second goes over.
+#define BUDGET_WAKEUPS 320
+#define BUDGET_WAKEUPS_PER_MIN 2
+#define BUDGET_PERSIST_READS 16
+#define BUDGET_PERSIST_READS_PER_MIN 0
+#define BUDGET_PERSIST_WRITES 8
+#define BUDGET_PERSIST_WRITES_PER_MIN 0
+#define BUDGET_LAYER_DIRTIES 480
+#define BUDGET_LAYER_DIRTIES_PER_MIN 2
+#define BUDGET_VIBES 8
+#define BUDGET_VIBES_PER_MIN 2
+#define BUDGET_MESSAGES 24
+#define BUDGET_MESSAGES_PER_MIN 0
+#define BUDGET_HEAP_BYTES 8192
+
+// Build with TIMR_POWER_STATS defined to count, otherwise this all compiles out
+#ifdef TIMR_POWER_STATS
+	
+#define STATS_COUNT(stat) power_stats_count(stat)
+#define STATS_SAMPLE_HEAP() power_stats_sample_heap()
+	
+void power_stats_init(void);
+void power_stats_count(PowerStat stat);
+void power_stats_sample_heap(void);
+uint32_t power_stats_budget(PowerStat stat, uint32_t minutes);
+bool power_stats_report(void);
+	
+#else
+	
+#define STATS_COUNT(stat)
+#define STATS_SAMPLE_HEAP()
+	
+#define power_stats_init()
+#define power_stats_report() true
+	
+#endif /* TIMR_POWER_STATS */
+
+#endif /* POWERSTATS_H_ */
@@ -0,0 +1,157 @@
+#include <pebble.h>
+
+#include "Timr.h"
+#include "Presenter.h"
+#include "TimerCore.h"
+#include "Comms.h"
+
+/*
+	Definitions
+	========================================================================================
+*/
+// What the phone was last sent, it works out the time left from this on its own
+typedef struct {
+	bool valid;
+	uint8_t state;
+	uint8_t segment;
+	uint16_t total;
+	int64_t end_ms;      // When the time is up, watch clock
+	int32_t remaining;   // Whole seconds left, negative in overtime
+} PresenterSnapshot;
+
+
+/*
+	Variables
+	========================================================================================
+*/
+static PresenterSnapshot s_sent;
+
+// Pending resend after a failed message, and how long the next one waits
+static AppTimer *s_retry_timer;
+static uint32_t s_retry_ms;
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+static uint8_t currentState(const TimerState *timer, int32_t remaining_ms){
+	if(timer->running)
+		return PRESENTER_RUNNING;
+	
+	if(!timer->overtime && remaining_ms == (int32_t) timer->timer_start_time * 1000)
+		return PRESENTER_STOPPED;
+	
+	return PRESENTER_PAUSED;
+}
+
+// Nothing the phone couldn't have worked out from the last message
+static bool alreadySent(const PresenterSnapshot *now){
+	if(!s_sent.valid || now->state != s_sent.state || now->segment != s_sent.segment || now->total != s_sent.total)
+		return false;
+	
+	if(now->state == PRESENTER_RUNNING){
+		int64_t drift = now->end_ms - s_sent.end_ms;
+		return drift < PRESENTER_MAX_DRIFT_MS && drift > -PRESENTER_MAX_DRIFT_MS;
+	}
+	
+	return now->remaining == s_sent.remaining;
+}
+
+// Send what changed. While running the remaining time is measured from the anchor, the
+// watch time to the whole second, so the phone can take out how long it took to arrive.
+static void sendState(){
+	const TimerState *timer = timer_core_get();
+	
+	time_t anchor;
+	uint16_t ms;
+	time_ms(&anchor, &ms);
+	
+	int32_t remaining_ms = timer->overtime ? -timer_core_overtime_ms() : timer_core_remaining_ms();
+	
+	PresenterSnapshot now = {
+		.valid = true,
+		.state = currentState(timer, remaining_ms),
+		.segment = timer->segment,
+		.total = timer->timer_start_time,
+		.end_ms = (int64_t) anchor * 1000 + ms + remaining_ms,
+		.remaining = remaining_ms / 1000
+	};
+	
+	if(alreadySent(&now))
+		return;
+	
+	// Busy with something else, sent again on COMMS_READY
+	DictionaryIterator *iter = comms_begin(COMMS_PRESENTER);
+	if(iter == NULL)
+		return;
+	
+	dict_write_uint8(iter, KEY_PRESENTER_STATE, now.state);
+	if(!s_sent.valid || now.segment != s_sent.segment)
+		dict_write_uint8(iter, KEY_PRESENTER_SEGMENT, now.segment);
+	if(!s_sent.valid || now.total != s_sent.total)
+		dict_write_uint16(iter, KEY_PRESENTER_TOTAL, now.total);
+	dict_write_uint32(iter, KEY_PRESENTER_ANCHOR, anchor);
+	dict_write_int32(iter, KEY_PRESENTER_REMAINING, now.state == PRESENTER_RUNNING ? remaining_ms + ms : remaining_ms);
+	comms_send();
+	
+	s_sent = now;
+}
+
+
+/*
+	Callbacks
+	========================================================================================
+*/
+// Ticks and cues are left to the phone, it only hears about changes
+static void timer_event_handler(TimerEventType event){
+	if(event == TIMER_EVENT_STATE || event == TIMER_EVENT_SEGMENT)
+		sendState();
+}
+
+static void retry_timer_callback(void *data){
+	s_retry_timer = NULL;
+	sendState();
+}
+
+static void comms_handler(CommsResult result){
+	switch(result){
+		// The phone may have missed it, the next message carries everything.
+		// Nothing else may change for a long while, so it is sent again later.
+		case COMMS_FAILED:
+			s_sent.valid = false;
+			if(s_retry_timer == NULL){
+				s_retry_timer = app_timer_register(s_retry_ms, retry_timer_callback, NULL);
+				s_retry_ms = s_retry_ms * 2 < PRESENTER_RETRY_MAX_MS ? s_retry_ms * 2 : PRESENTER_RETRY_MAX_MS;
+			}
+			break;
+		case COMMS_SENT:
+			s_retry_ms = PRESENTER_RETRY_MS;
+			break;
+		case COMMS_READY:
+			sendState();
+			break;
+	}
+}
+
+
+/*
+	Init and Deinit
+	========================================================================================
+*/
+void presenter_init(){
+	s_sent.valid = false;
+	s_retry_ms = PRESENTER_RETRY_MS;
+	comms_set_handler(COMMS_PRESENTER, comms_handler);
+	timer_core_subscribe(timer_event_handler);
+	sendState();
+}
+
+void presenter_deinit(){
+	timer_core_unsubscribe(timer_event_handler);
+	
+	if(s_retry_timer){
+		app_timer_cancel(s_retry_timer);
+		s_retry_timer = NULL;
+	}
+}
@@ -0,0 +1,27 @@
+/*
+ * Presenter.h
+ */
+
+#ifndef PRESENTER_H_
+#define PRESENTER_H_
+
+#include <pebble.h>
+
+// What the phone is told the timer is doing, presenter.js decodes the same values
+typedef enum {
+	PRESENTER_STOPPED,
+	PRESENTER_RUNNING,
+	PRESENTER_PAUSED
+} PresenterState;
+
+// How far the end time can drift from what the phone last got before it is sent again
+#define PRESENTER_MAX_DRIFT_MS 1000
+
+// A message that fails is sent again after this, doubled each time it fails again
+#define PRESENTER_RETRY_MS 2000
+#define PRESENTER_RETRY_MAX_MS 60000
+
+void presenter_init(void);
+void presenter_deinit(void);
+
+#endif /* PRESENTER_H_ */
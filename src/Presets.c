@@ -0,0 +1,31 @@
+#include <pebble.h>
+
+#include "Presets.h"
+
+/*
+	Preset Table
+	========================================================================================
+*/
+// Built in, nothing is read or written to switch between them
+static const Preset s_presets[] = {
+	{ "Lightning", 5 * 60, 60, 60 },
+	{ "Talk", 20 * 60, 5 * 60, 2 * 60 },
+	{ "Keynote", 45 * 60, 10 * 60, 5 * 60 },
+};
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+uint8_t preset_count(){
+	return ARRAY_LENGTH(s_presets);
+}
+
+// Presets are selected from 1, PRESET_NONE (or anything out of range) is no preset
+const Preset* preset_get(uint8_t selected){
+	if(selected == PRESET_NONE || selected > ARRAY_LENGTH(s_presets))
+		return NULL;
+	
+	return &s_presets[selected - 1];
+}
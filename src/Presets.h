@@ -0,0 +1,26 @@
+/*
+ * Presets.h
+ */
+
+#ifndef PRESETS_H_
+#define PRESETS_H_
+
+#include <pebble.h>
+
+#define PRESET_NAME_LENGTH 12
+
+// Selected preset value for the times from the settings
+#define PRESET_NONE 0
+
+// One ready made setup, every preset lives in a single const table
+typedef struct __attribute__((__packed__)) {
+	char name[PRESET_NAME_LENGTH];
+	uint16_t timer_start_time;
+	uint16_t interval_time;
+	uint16_t final_warning_time;
+} Preset;
+
+uint8_t preset_count(void);
+const Preset* preset_get(uint8_t selected);
+
+#endif /* PRESETS_H_ */
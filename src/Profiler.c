@@ -0,0 +1,170 @@
+#include <pebble.h>
+
+#include "Profiler.h"
+#include "Countdown.h"
+
+#ifdef TIMR_PROFILE
+
+/*
+	Variables
+	========================================================================================
+*/
+static ProfileRecord s_ring[PROFILE_RING_SIZE];
+static uint8_t s_ring_next;
+static uint8_t s_ring_count;
+
+static const char *s_point_names[NUM_PROFILE_POINTS] = {
+	"wake",
+	"text",
+	"set text",
+	"load",
+	"unload",
+	"cue late",
+	"first frame",
+};
+
+// Launch time, cleared once the first frame has been measured
+static int64_t s_launch_ms;
+static uint16_t s_first_frame_ms;
+
+// Hidden debug screen
+static Window *s_debug_window;
+static TextLayer *s_debug_text_layer;
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+static void addRecord(uint8_t point, int32_t duration_ms, size_t heap_before, size_t heap_after){
+	ProfileRecord *record = &s_ring[s_ring_next];
+	
+	record->point = point;
+	record->duration_ms = duration_ms > UINT16_MAX ? UINT16_MAX : (duration_ms < 0 ? 0 : duration_ms);
+	record->heap_before = heap_before;
+	record->heap_after = heap_after;
+	
+	s_ring_next = (s_ring_next + 1) % PROFILE_RING_SIZE;
+	if(s_ring_count < PROFILE_RING_SIZE)
+		s_ring_count++;
+}
+
+ProfileMark profiler_begin(ProfilePoint point){
+	return (ProfileMark) {
+		.point = point,
+		.start_ms = countdown_now_ms(),
+		.heap_before = heap_bytes_used(),
+	};
+}
+
+void profiler_end(const ProfileMark *mark){
+	addRecord(mark->point, (int32_t) (countdown_now_ms() - mark->start_ms), mark->heap_before, heap_bytes_used());
+}
+
+// Record a duration measured somewhere else, like how late a cue played
+void profiler_record(ProfilePoint point, int32_t duration_ms){
+	size_t heap = heap_bytes_used();
+	addRecord(point, duration_ms, heap, heap);
+}
+
+// Called first thing in main
+void profiler_launch(){
+	s_launch_ms = countdown_now_ms();
+}
+
+// Called on every draw of the digits, only the first one after launch is measured
+void profiler_first_frame(){
+	if(s_launch_ms == 0)
+		return;
+	
+	int32_t duration_ms = (int32_t) (countdown_now_ms() - s_launch_ms);
+	s_launch_ms = 0;
+	s_first_frame_ms = duration_ms > UINT16_MAX ? UINT16_MAX : duration_ms;
+	profiler_record(PROFILE_FIRST_FRAME, duration_ms);
+}
+
+// Launch to first frame, 0 until it has been drawn
+uint16_t profiler_first_frame_ms(){
+	return s_first_frame_ms;
+}
+
+// Log every record in the ring, oldest first
+void profiler_dump(){
+	APP_LOG(s_first_frame_ms > BUDGET_FIRST_FRAME_MS ? APP_LOG_LEVEL_WARNING : APP_LOG_LEVEL_INFO,
+		"first frame: %dms (budget %d)", s_first_frame_ms, BUDGET_FIRST_FRAME_MS);
+	
+	uint8_t first = (s_ring_next + PROFILE_RING_SIZE - s_ring_count) % PROFILE_RING_SIZE;
+	
+	for(int i = 0; i < s_ring_count; i++){
+		const ProfileRecord *record = &s_ring[(first + i) % PROFILE_RING_SIZE];
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "%s: %dms heap %d -> %d", s_point_names[record->point],
+			record->duration_ms, record->heap_before, record->heap_after);
+	}
+}
+
+// Worst and last duration of every point, for the debug screen
+const char* profiler_summary(){
+	static char s_summary[256];
+	uint16_t worst[NUM_PROFILE_POINTS] = { 0 };
+	uint16_t last[NUM_PROFILE_POINTS] = { 0 };
+	uint16_t heap = 0;
+	int length = 0;
+	
+	uint8_t first = (s_ring_next + PROFILE_RING_SIZE - s_ring_count) % PROFILE_RING_SIZE;
+	for(int i = 0; i < s_ring_count; i++){
+		const ProfileRecord *record = &s_ring[(first + i) % PROFILE_RING_SIZE];
+		if(record->duration_ms > worst[record->point])
+			worst[record->point] = record->duration_ms;
+		last[record->point] = record->duration_ms;
+		heap = record->heap_after;
+	}
+	
+	for(int i = 0; i < NUM_PROFILE_POINTS && length < (int) sizeof(s_summary); i++)
+		length += snprintf(s_summary + length, sizeof(s_summary) - length, "%s: %d/%dms\n", s_point_names[i], last[i], worst[i]);
+	
+	if(length < (int) sizeof(s_summary))
+		length += snprintf(s_summary + length, sizeof(s_summary) - length, "launch: %dms\n", s_first_frame_ms);
+	
+	if(length < (int) sizeof(s_summary))
+		snprintf(s_summary + length, sizeof(s_summary) - length, "heap: %d", heap);
+	
+	return s_summary;
+}
+
+
+/*
+	Debug Window
+	========================================================================================
+*/
+static void debug_window_appear(Window *window){
+	text_layer_set_text(s_debug_text_layer, profiler_summary());
+}
+
+// Hidden screen listing last/worst durations, created once like the other windows
+Window* debug_window_get(){
+	
+	if(s_debug_window == NULL){
+		s_debug_window = window_create();
+		window_set_window_handlers(s_debug_window, (WindowHandlers) {
+			.appear = debug_window_appear,
+		});
+		
+		Layer *window_layer = window_get_root_layer(s_debug_window);
+		s_debug_text_layer = text_layer_create(layer_get_bounds(window_layer));
+		text_layer_set_font(s_debug_text_layer, fonts_get_system_font(FONT_KEY_GOTHIC_14));
+		layer_add_child(window_layer, text_layer_get_layer(s_debug_text_layer));
+	}
+	
+	return s_debug_window;
+}
+
+void debug_window_deinit(){
+	if(s_debug_window == NULL)
+		return;
+	
+	text_layer_destroy(s_debug_text_layer);
+	window_destroy(s_debug_window);
+	s_debug_window = NULL;
+}
+
+#endif /* TIMR_PROFILE */
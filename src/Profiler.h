@@ -0,0 +1,75 @@
+/*
+ * Profiler.h
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <pebble.h>
+
+// What gets profiled
+typedef enum {
+	PROFILE_WAKE,
+	PROFILE_UPDATE_TEXT,
+	PROFILE_UPDATE_SET_TEXT,
+	PROFILE_WINDOW_LOAD,
+	PROFILE_WINDOW_UNLOAD,
+	PROFILE_CUE_LATENCY,
+	PROFILE_FIRST_FRAME,
+	NUM_PROFILE_POINTS
+} ProfilePoint;
+
+// Launch to first frame budget, a presenter may open the app right before going on stage
+#define BUDGET_FIRST_FRAME_MS 150
+
+// One call, kept in a fixed size ring buffer
+#define PROFILE_RING_SIZE 32
+
+typedef struct {
+	uint8_t point;
+	uint16_t duration_ms;
+	uint16_t heap_before;
+	uint16_t heap_after;
+} ProfileRecord;
+
+// Taken at the start of a profiled call
+typedef struct {
+	uint8_t point;
+	int64_t start_ms;
+	uint16_t heap_before;
+} ProfileMark;
+
+// Build with TIMR_PROFILE defined to profile, otherwise this all compiles out
+#ifdef TIMR_PROFILE
+	
+#define PROFILE_BEGIN(point) ProfileMark profile_mark = profiler_begin(point)
+#define PROFILE_END() profiler_end(&profile_mark)
+#define PROFILE_CUE_LATE(late_ms) profiler_record(PROFILE_CUE_LATENCY, late_ms)
+#define PROFILE_LAUNCH() profiler_launch()
+#define PROFILE_FIRST_FRAME() profiler_first_frame()
+	
+ProfileMark profiler_begin(ProfilePoint point);
+void profiler_end(const ProfileMark *mark);
+void profiler_record(ProfilePoint point, int32_t duration_ms);
+void profiler_launch(void);
+void profiler_first_frame(void);
+uint16_t profiler_first_frame_ms(void);
+void profiler_dump(void);
+const char* profiler_summary(void);
+Window* debug_window_get(void);
+void debug_window_deinit(void);
+	
+#else
+	
+#define PROFILE_BEGIN(point)
+#define PROFILE_END()
+#define PROFILE_CUE_LATE(late_ms)
+#define PROFILE_LAUNCH()
+#define PROFILE_FIRST_FRAME()
+	
+#define profiler_dump()
+#define debug_window_deinit()
+	
+#endif /* TIMR_PROFILE */
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,163 @@
+#include <pebble.h>
+
+#include "ProgressLayer.h"
+#include "PowerStats.h"
+
+/*
+	Definitions
+	========================================================================================
+*/
+// Thickness of the filled ring or bar
+#define RING_WIDTH 6
+#define BAR_WIDTH 6
+
+// How far cue marks sit from the ring or bar
+#define MARK_OFFSET 5
+
+
+/*
+	Variables
+	========================================================================================
+*/
+// Data of the progress layer. points are the ends of the pieces along the path,
+// worked out once. fill_time is the elapsed seconds each piece fills at and marks
+// are the cue points, both rebuilt when the times change.
+typedef struct {
+	GPoint points[PROGRESS_SEGMENTS + 1];
+	uint16_t fill_time[PROGRESS_SEGMENTS];
+	GPoint marks[CUE_MAX];
+	uint8_t num_marks;
+	uint8_t filled;
+} ProgressLayerData;
+
+
+/*
+	Geometry
+	========================================================================================
+*/
+// Point num / den of the way along the path, offset pixels to the inside of
+// the ring or to the right of the bar. Angles are fixed point, TRIG_MAX_ANGLE a turn.
+static GPoint pathPoint(GRect bounds, uint32_t num, uint32_t den, int16_t offset){
+#ifdef PBL_ROUND
+	int32_t angle = (int32_t) (TRIG_MAX_ANGLE * num / den);
+	int32_t radius = bounds.size.w / 2 - RING_WIDTH / 2 - 1 - offset;
+	return GPoint(bounds.size.w / 2 + sin_lookup(angle) * radius / TRIG_MAX_RATIO,
+		bounds.size.h / 2 - cos_lookup(angle) * radius / TRIG_MAX_RATIO);
+#else
+	return GPoint(offset, (int16_t) (bounds.size.h * num / den));
+#endif
+}
+
+
+/*
+	Drawing
+	========================================================================================
+*/
+// Filled pieces up to data->filled, a thin track after them, then the cue marks
+static void progress_layer_update_proc(Layer *layer, GContext *ctx){
+	ProgressLayerData *data = layer_get_data(layer);
+	
+	graphics_context_set_stroke_color(ctx, GColorBlack);
+	graphics_context_set_fill_color(ctx, GColorBlack);
+	
+	for(int i = 0; i < PROGRESS_SEGMENTS; i++){
+		bool filled = i < data->filled;
+		GPoint from = data->points[i];
+		GPoint to = data->points[i + 1];
+#ifdef PBL_ROUND
+		graphics_context_set_stroke_width(ctx, filled ? RING_WIDTH : 1);
+		graphics_draw_line(ctx, from, to);
+#else
+		if(filled)
+			graphics_fill_rect(ctx, GRect(0, from.y, BAR_WIDTH, to.y - from.y), 0, GCornerNone);
+		else
+			graphics_draw_line(ctx, GPoint(BAR_WIDTH / 2, from.y), GPoint(BAR_WIDTH / 2, to.y));
+#endif
+	}
+	
+	for(int i = 0; i < data->num_marks; i++){
+#ifdef PBL_ROUND
+		graphics_fill_circle(ctx, data->marks[i], 1);
+#else
+		graphics_fill_rect(ctx, GRect(data->marks[i].x, data->marks[i].y - 1, 3, 2), 0, GCornerNone);
+#endif
+	}
+}
+
+
+/*
+	Create and Destroy
+	========================================================================================
+*/
+// The end points of every piece are worked out once, here
+ProgressLayer* progress_layer_create(GRect frame){
+	
+	ProgressLayer *progress_layer = layer_create_with_data(frame, sizeof(ProgressLayerData));
+	ProgressLayerData *data = layer_get_data(progress_layer);
+	GRect bounds = layer_get_bounds(progress_layer);
+	data->num_marks = 0;
+	data->filled = 0;
+	layer_set_update_proc(progress_layer, progress_layer_update_proc);
+	
+	for(int i = 0; i <= PROGRESS_SEGMENTS; i++)
+		data->points[i] = pathPoint(bounds, i, PROGRESS_SEGMENTS, 0);
+	
+	for(int i = 0; i < PROGRESS_SEGMENTS; i++)
+		data->fill_time[i] = 0;
+	
+	return progress_layer;
+}
+
+void progress_layer_destroy(ProgressLayer *progress_layer){
+	layer_destroy(progress_layer);
+}
+
+Layer* progress_layer_get_layer(ProgressLayer *progress_layer){
+	return progress_layer;
+}
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+// Rebuild the fill times and cue marks for a countdown of total seconds, only
+// needed when the times change. Leaves every piece empty.
+void progress_layer_set_cues(ProgressLayer *progress_layer, const CueTimeline *timeline, uint16_t total){
+	ProgressLayerData *data = layer_get_data(progress_layer);
+	GRect bounds = layer_get_bounds(progress_layer);
+	
+	for(int i = 0; i < PROGRESS_SEGMENTS; i++)
+		data->fill_time[i] = ((uint32_t) total * (i + 1) + PROGRESS_SEGMENTS - 1) / PROGRESS_SEGMENTS;
+	data->filled = 0;
+	
+	// Interval and final warning cues get a mark, the rest are too close to the end
+	data->num_marks = 0;
+	for(int i = 0; total > 0 && i < timeline->count; i++){
+		const Cue *cue = &timeline->cues[i];
+		if(cue->type == CUE_INTERVAL || cue->type == CUE_FINAL_WARNING)
+			data->marks[data->num_marks++] = pathPoint(bounds, total - cue->remaining, total, MARK_OFFSET + RING_WIDTH / 2);
+	}
+	
+	layer_mark_dirty(progress_layer);
+	STATS_COUNT(STAT_LAYER_DIRTY);
+}
+
+// Fill up to elapsed seconds, only marked dirty when a piece fills or empties
+void progress_layer_set_elapsed(ProgressLayer *progress_layer, uint16_t elapsed){
+	ProgressLayerData *data = layer_get_data(progress_layer);
+	uint8_t filled = data->filled;
+	
+	while(filled < PROGRESS_SEGMENTS && data->fill_time[filled] <= elapsed)
+		filled++;
+	
+	while(filled > 0 && data->fill_time[filled - 1] > elapsed)
+		filled--;
+	
+	if(filled == data->filled)
+		return;
+	
+	data->filled = filled;
+	layer_mark_dirty(progress_layer);
+	STATS_COUNT(STAT_LAYER_DIRTY);
+}
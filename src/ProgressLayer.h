@@ -0,0 +1,24 @@
+/*
+ * ProgressLayer.h
+ */
+
+#ifndef PROGRESSLAYER_H_
+#define PROGRESSLAYER_H_
+
+#include <pebble.h>
+
+#include "Cues.h"
+
+// Pieces the indicator is split into, it fills a piece at a time
+#define PROGRESS_SEGMENTS 32
+
+// A ring around the edge on round screens, a bar down the left on rectangular ones
+typedef Layer ProgressLayer;
+
+ProgressLayer* progress_layer_create(GRect frame);
+void progress_layer_destroy(ProgressLayer *progress_layer);
+Layer* progress_layer_get_layer(ProgressLayer *progress_layer);
+void progress_layer_set_cues(ProgressLayer *progress_layer, const CueTimeline *timeline, uint16_t total);
+void progress_layer_set_elapsed(ProgressLayer *progress_layer, uint16_t elapsed);
+
+#endif /* PROGRESSLAYER_H_ */
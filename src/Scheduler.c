@@ -0,0 +1,88 @@
+#include <pebble.h>
+
+#include "Scheduler.h"
+#include "PowerStats.h"
+
+/*
+	Variables
+	========================================================================================
+*/
+static SchedulerHandler s_handler;
+
+// Current tick subscription, 0 when unsubscribed
+static TimeUnits s_unit;
+
+// One shot timer for events between ticks (vibration cues)
+static AppTimer *s_wake_timer;
+
+
+/*
+	Callbacks
+	========================================================================================
+*/
+static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
+	STATS_COUNT(STAT_WAKEUP);
+	STATS_SAMPLE_HEAP();
+	
+	if(s_handler)
+		s_handler();
+}
+
+static void wake_timer_callback(void *data){
+	s_wake_timer = NULL;
+	STATS_COUNT(STAT_WAKEUP);
+	STATS_SAMPLE_HEAP();
+	
+	if(s_handler)
+		s_handler();
+}
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+void scheduler_init(SchedulerHandler handler){
+	s_handler = handler;
+	s_unit = 0;
+	s_wake_timer = NULL;
+}
+
+// Subscribe to ticks at the given unit while awake, sleep otherwise.
+// Only talks to the tick service when something actually changes.
+void scheduler_update(bool awake, TimeUnits unit){
+	
+	TimeUnits new_unit = awake ? unit : 0;
+	
+	if(new_unit == s_unit)
+		return;
+	
+	if(new_unit == 0)
+		tick_timer_service_unsubscribe();
+	else
+		tick_timer_service_subscribe(new_unit, tick_handler);
+	
+	s_unit = new_unit;
+	
+	// Nothing left to wake up for
+	if(!awake)
+		scheduler_cancel_wake();
+}
+
+// Wake once in ms, used for cues that don't land on a tick
+void scheduler_wake_in(uint32_t ms){
+	if(s_wake_timer == NULL || !app_timer_reschedule(s_wake_timer, ms))
+		s_wake_timer = app_timer_register(ms, wake_timer_callback, NULL);
+}
+
+void scheduler_cancel_wake(){
+	if(s_wake_timer){
+		app_timer_cancel(s_wake_timer);
+		s_wake_timer = NULL;
+	}
+}
+
+void scheduler_deinit(){
+	scheduler_update(false, 0);
+	s_handler = NULL;
+}
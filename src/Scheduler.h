@@ -0,0 +1,22 @@
+/*
+ * Scheduler.h
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <pebble.h>
+
+// Unit for waking on timers alone, with no ticks
+#define SCHEDULER_NO_TICKS 0
+
+// Called whenever the scheduler wakes the app up
+typedef void (*SchedulerHandler)(void);
+
+void scheduler_init(SchedulerHandler handler);
+void scheduler_update(bool awake, TimeUnits unit);
+void scheduler_wake_in(uint32_t ms);
+void scheduler_cancel_wake(void);
+void scheduler_deinit(void);
+
+#endif /* SCHEDULER_H_ */
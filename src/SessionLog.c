@@ -0,0 +1,225 @@
+#include <pebble.h>
+
+#include "Timr.h"
+#include "SessionLog.h"
+#include "PowerStats.h"
+#include "Comms.h"
+#include "TimerCore.h"
+
+/*
+	Definitions
+	========================================================================================
+*/
+#define SESSION_LOG_VERSION 1
+
+// The event logged for each TimerChange, the first (a reset) isn't logged
+static const SessionEvent s_change_events[] = {
+	[TIMER_CHANGE_START] = SESSION_START,
+	[TIMER_CHANGE_RESUME] = SESSION_RESUME,
+	[TIMER_CHANGE_PAUSE] = SESSION_PAUSE,
+	[TIMER_CHANGE_STOP] = SESSION_STOP,
+	[TIMER_CHANGE_RESTART] = SESSION_RESTART,
+	[TIMER_CHANGE_TIME_UP] = SESSION_TIME_UP,
+};
+
+// Where the ring is, stored in SESSION_LOG_HEAD
+typedef struct __attribute__((__packed__)) {
+	uint8_t version;
+	uint16_t next;
+	uint16_t count;
+} SessionLogHead;
+
+
+/*
+	Variables
+	========================================================================================
+*/
+static SessionLogHead s_head;
+static bool s_head_loaded;
+static bool s_head_dirty;
+
+// Only one block is in memory, records are added to it until it fills up
+static SessionRecord s_block[SESSION_RECORDS_PER_BLOCK];
+static int8_t s_block_index = -1;
+static bool s_block_dirty;
+
+// Records added since launch
+static uint8_t s_added;
+
+// Export progress
+static bool s_exporting;
+static uint16_t s_exported;
+
+
+/*
+	Storage
+	========================================================================================
+*/
+static void loadHead(){
+	if(s_head_loaded)
+		return;
+	
+	s_head_loaded = true;
+	STATS_COUNT(STAT_PERSIST_READ);
+	if(persist_read_data(SESSION_LOG_HEAD, &s_head, sizeof(s_head)) != sizeof(s_head) ||
+		s_head.version != SESSION_LOG_VERSION || s_head.next >= SESSION_LOG_CAPACITY){
+		
+		s_head = (SessionLogHead) { .version = SESSION_LOG_VERSION };
+	}
+}
+
+static void writeBlock(){
+	if(!s_block_dirty)
+		return;
+	
+	persist_write_data(SESSION_LOG_BLOCK + s_block_index, s_block, sizeof(s_block));
+	STATS_COUNT(STAT_PERSIST_WRITE);
+	s_block_dirty = false;
+}
+
+// Swap in the block holding record index, writing the current one out first
+static void loadBlock(uint16_t index){
+	int8_t block = index / SESSION_RECORDS_PER_BLOCK;
+	if(block == s_block_index)
+		return;
+	
+	writeBlock();
+	
+	STATS_COUNT(STAT_PERSIST_READ);
+	if(persist_read_data(SESSION_LOG_BLOCK + block, s_block, sizeof(s_block)) != sizeof(s_block))
+		memset(s_block, 0, sizeof(s_block));
+	s_block_index = block;
+}
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+// Add an event, kept in memory until its block fills up or the log is flushed
+void session_log_add(SessionEvent event, uint8_t detail, uint16_t value){
+	if(s_added >= SESSION_LOG_MAX_RECORDS)
+		return;
+	
+	s_added++;
+	loadHead();
+	loadBlock(s_head.next);
+	
+	s_block[s_head.next % SESSION_RECORDS_PER_BLOCK] = (SessionRecord) {
+		.time = time(NULL),
+		.value = value,
+		.event = event,
+		.detail = detail,
+	};
+	s_block_dirty = true;
+	
+	// The oldest record goes once the ring is full
+	s_head.next = (s_head.next + 1) % SESSION_LOG_CAPACITY;
+	if(s_head.count < SESSION_LOG_CAPACITY)
+		s_head.count++;
+	s_head_dirty = true;
+}
+
+// Write whatever is left in memory, nothing is written if no event was added
+void session_log_flush(){
+	writeBlock();
+	
+	if(s_head_dirty){
+		persist_write_data(SESSION_LOG_HEAD, &s_head, sizeof(s_head));
+		STATS_COUNT(STAT_PERSIST_WRITE);
+		s_head_dirty = false;
+	}
+}
+
+
+/*
+	Timer Events
+	========================================================================================
+*/
+// Everything the timer does is logged as it happens
+static void timer_event_handler(TimerEventType event){
+	const TimerState *state = timer_core_get();
+	
+	switch(event){
+		case TIMER_EVENT_CUE:
+			session_log_add(SESSION_CUE, state->cue, state->overtime ? state->overtime_time : state->time);
+		break;
+		case TIMER_EVENT_SEGMENT:
+			session_log_add(SESSION_SEGMENT, state->segment, state->timer_start_time);
+		break;
+		case TIMER_EVENT_STATE:
+			if(state->change != TIMER_CHANGE_RESET)
+				session_log_add(s_change_events[state->change], state->change_segment, state->change_time);
+		break;
+		default:
+		break;
+	}
+}
+
+void session_log_init(){
+	timer_core_subscribe(timer_event_handler);
+}
+
+void session_log_deinit(){
+	timer_core_unsubscribe(timer_event_handler);
+}
+
+
+/*
+	Export
+	========================================================================================
+*/
+// Send the next batch, oldest records first. An empty log still sends one
+// message so the phone knows there is nothing.
+static void sendBatch(){
+	SessionRecord batch[SESSION_LOG_BATCH];
+	uint8_t length = 0;
+	uint16_t first = (s_head.next + SESSION_LOG_CAPACITY - s_head.count) % SESSION_LOG_CAPACITY;
+	
+	while(length < SESSION_LOG_BATCH && s_exported + length < s_head.count){
+		uint16_t index = (first + s_exported + length) % SESSION_LOG_CAPACITY;
+		loadBlock(index);
+		batch[length++] = s_block[index % SESSION_RECORDS_PER_BLOCK];
+	}
+	
+	// Busy with something else, picked up again on COMMS_READY
+	DictionaryIterator *iter = comms_begin(COMMS_SESSION_LOG);
+	if(iter == NULL)
+		return;
+	
+	dict_write_data(iter, KEY_LOG_RECORDS, (const uint8_t *) batch, length * sizeof(SessionRecord));
+	dict_write_uint16(iter, KEY_LOG_OFFSET, s_exported);
+	dict_write_uint16(iter, KEY_LOG_TOTAL, s_head.count);
+	comms_send();
+	
+	s_exported += length;
+}
+
+static void comms_handler(CommsResult result){
+	if(!s_exporting)
+		return;
+	
+	if(result == COMMS_FAILED){
+		APP_LOG(APP_LOG_LEVEL_WARNING, "Session log export failed");
+		s_exporting = false;
+	}else if(result == COMMS_READY || s_exported < s_head.count){
+		sendBatch();
+	}else{
+		s_exporting = false;
+	}
+}
+
+// Send the whole log to the phone, one batch after another
+void session_log_export(){
+	if(s_exporting)
+		return;
+	
+	// Everything has to be in flash for the blocks to be swapped in
+	loadHead();
+	session_log_flush();
+	
+	comms_set_handler(COMMS_SESSION_LOG, comms_handler);
+	s_exporting = true;
+	s_exported = 0;
+	sendBatch();
+}
@@ -0,0 +1,48 @@
+/*
+ * SessionLog.h
+ */
+
+#ifndef SESSIONLOG_H_
+#define SESSIONLOG_H_
+
+#include <pebble.h>
+
+// What happened, the phone side decodes the same values
+typedef enum {
+	SESSION_START,
+	SESSION_PAUSE,
+	SESSION_RESUME,
+	SESSION_RESTART,
+	SESSION_CUE,
+	SESSION_SEGMENT,
+	SESSION_TIME_UP,
+	SESSION_STOP
+} SessionEvent;
+
+// One event, 8 bytes. value is the seconds left, or past zero once in overtime.
+// detail is the cue type for SESSION_CUE and the segment otherwise.
+typedef struct __attribute__((__packed__)) {
+	uint32_t time;
+	uint16_t value;
+	uint8_t event;
+	uint8_t detail;
+} SessionRecord;
+
+// The ring is spread over SESSION_LOG_BLOCKS keys of whole records
+#define SESSION_RECORDS_PER_BLOCK (PERSIST_DATA_MAX_LENGTH / sizeof(SessionRecord))
+#define SESSION_LOG_BLOCKS 4
+#define SESSION_LOG_CAPACITY (SESSION_RECORDS_PER_BLOCK * SESSION_LOG_BLOCKS)
+
+// Records kept per launch, so a launch writes at most 3 blocks and the head
+#define SESSION_LOG_MAX_RECORDS 64
+
+// Records per AppMessage when exporting
+#define SESSION_LOG_BATCH 16
+
+void session_log_init(void);
+void session_log_deinit(void);
+void session_log_add(SessionEvent event, uint8_t detail, uint16_t value);
+void session_log_flush(void);
+void session_log_export(void);
+
+#endif /* SESSIONLOG_H_ */
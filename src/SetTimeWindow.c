@@ -1,8 +1,12 @@
 #include <pebble.h>
-#include <pebble_fonts.h>
 
 #include "Timr.h"
 #include "SetTimeWindow.h"
+#include "Settings.h"
+#include "IconCache.h"
+#include "DigitLayer.h"
+#include "Layout.h"
+#include "Profiler.h"
 
 /*
 	Variables
@@ -11,16 +15,11 @@
 // The window
 static Window *window;
 
-// Where text will show up
-static TextLayer *minute_text_wrapper;
-static TextLayer *second_text_wrapper;
-static TextLayer *minute_text_layer;
-static TextLayer *second_text_layer;
-
-
+// Where the time will show up, the field being edited is highlighted
+static DigitLayer *digit_layer;
 
 // The action bar
-ActionBarLayer *action_bar;
+static ActionBarLayer *action_bar;
 static GBitmap *my_icon_plus;
 static GBitmap *my_icon_minus;
 static GBitmap *my_icon_settings;
@@ -34,6 +33,20 @@ static uint8_t s_time_to_be_set;
 // To track which variable is being edited
 static bool field_to_edit;
 
+/*
+	Definitions
+	========================================================================================
+*/
+// Largest time that can be shown
+#define MAX_SET_TIME 3599
+
+// Held buttons repeat this often, and step further the longer they're held
+#define REPEAT_INTERVAL_MS 100
+#define REPEATS_TO_MEDIUM_STEP 5
+#define REPEATS_TO_LARGE_STEP 15
+#define MEDIUM_STEP 5
+#define LARGE_STEP 10
+
 /*
 	Button Callbacks
 	========================================================================================
@@ -43,80 +56,71 @@ static void button_back_single(ClickRecognizerRef recognizer, void* context)
 	
 	switch(s_time_to_be_set){
 		case SET_TIMER_START_WINDOW: 
-  		persist_write_int(TIMER_START_TIME, timer_set_time);
+  		settings_set(TIMER_START_TIME, timer_set_time);
 		break;
 		case SET_TIMER_INTERVAL_WINDOW: 
-  		persist_write_int(INTERVAL_TIME, timer_set_time);
+  		settings_set(INTERVAL_TIME, timer_set_time);
 		break;
 		case SET_FINAL_WARNING_WINDOW: 
-  		persist_write_int(FINAL_WARNING_TIME, timer_set_time);
+  		settings_set(FINAL_WARNING_TIME, timer_set_time);
 		break;
 	}
 	
 	window_stack_pop(ANIMATED);
 }
 
-static void setTextLayerTheme(TextLayer* layer, uint8_t theme){
-	if(theme == DARK){
-		text_layer_set_background_color(layer, GColorBlack);
-		text_layer_set_text_color(layer, GColorWhite);
-	}
-	else if(theme == LIGHT){
-		text_layer_set_background_color(layer, GColorWhite);
-		text_layer_set_text_color(layer, GColorBlack);
-	}
+// Highlight the field being edited
+static void setFieldToEdit(bool field){
+	field_to_edit = field;
+	digit_layer_set_highlight(digit_layer, (field == MINUTES) ? DIGIT_ROW_MINUTES : DIGIT_ROW_SECONDS);
 }
 
 static void center_click_handler(ClickRecognizerRef recognizer, void* context)
 {
+	// Switch between editing minutes and seconds
+	setFieldToEdit(field_to_edit == MINUTES ? SECONDS : MINUTES);
+}
+
+// How far one click moves the time, grows the longer the button is held
+static uint16_t stepSize(ClickRecognizerRef recognizer){
+	uint8_t repeats = click_number_of_clicks_counted(recognizer);
+	uint16_t unit = (field_to_edit == SECONDS) ? 1 : 60;
 	
-	
-	// Change field to edit to seconds
-	if(field_to_edit == MINUTES){
-		field_to_edit = SECONDS;
-		
-		// Set minutes layer light
-		setTextLayerTheme(minute_text_wrapper, LIGHT);
-		setTextLayerTheme(minute_text_layer, LIGHT);
-		
-		// Set seconds layer dark
-		setTextLayerTheme(second_text_wrapper, DARK);
-		setTextLayerTheme(second_text_layer, DARK);
-		
-	}else{
-		field_to_edit = MINUTES;
-		
-		// Set minutes layer dark
-		setTextLayerTheme(minute_text_wrapper, DARK);
-		setTextLayerTheme(minute_text_layer, DARK);
-		
-		// Set seconds layer light
-		setTextLayerTheme(second_text_wrapper, LIGHT);
-		setTextLayerTheme(second_text_layer, LIGHT);
-		
-		
-	}
-	
-	
+	if(repeats > REPEATS_TO_LARGE_STEP)
+		return unit * LARGE_STEP;
+	if(repeats > REPEATS_TO_MEDIUM_STEP)
+		return unit * MEDIUM_STEP;
+	return unit;
+}
+
+// Accelerated steps land on whole multiples of themselves, single clicks move by one unit
+static bool isAccelerated(uint16_t step){
+	return step > ((field_to_edit == SECONDS) ? 1 : 60);
 }
 
 static void up_click_handler(ClickRecognizerRef recognizer, void *context) {
 	
-	timer_set_time += (field_to_edit == SECONDS) ? 1 : 60;
+	uint16_t step = stepSize(recognizer);
+	int new_time = isAccelerated(step) ? (timer_set_time / step) * step + step : timer_set_time + step;
+	
+	timer_set_time = new_time > MAX_SET_TIME ? MAX_SET_TIME : new_time;
 	updateSetTextLayer();
 }
 
 static void down_click_handler(ClickRecognizerRef recognizer, void *context) {
 	
-	timer_set_time -= (field_to_edit == SECONDS) ? 1 : 60;
+	uint16_t step = stepSize(recognizer);
+	int new_time = (isAccelerated(step) && timer_set_time % step) ? (timer_set_time / step) * step : timer_set_time - step;
+	
+	timer_set_time = new_time < 0 ? 0 : new_time;
 	updateSetTextLayer();
 
 }
 
 static void click_config_provider(void *context) {
   window_single_click_subscribe(BUTTON_ID_SELECT, center_click_handler);
-  window_single_click_subscribe(BUTTON_ID_UP, up_click_handler);
-  window_single_click_subscribe(BUTTON_ID_DOWN, down_click_handler);
+  window_single_repeating_click_subscribe(BUTTON_ID_UP, REPEAT_INTERVAL_MS, up_click_handler);
+  window_single_repeating_click_subscribe(BUTTON_ID_DOWN, REPEAT_INTERVAL_MS, down_click_handler);
   window_single_click_subscribe(BUTTON_ID_BACK, button_back_single);
 }
 /*
@@ -126,21 +130,16 @@ static void click_config_provider(void *context) {
 
 // Set UI elements
 void updateSetTextLayer(){
+	PROFILE_BEGIN(PROFILE_UPDATE_SET_TEXT);
 	
-  // Use a long-lived buffer
-  static char s_minute_buffer[32];
-  static char s_second_buffer[32];
-
   // Get time since launch
   int seconds = timer_set_time % 60;
   int minutes = (timer_set_time % 3600) / 60;
 
-  // Update the TextLayer
-  snprintf(s_minute_buffer, sizeof(s_minute_buffer), "%d", minutes);
-  text_layer_set_text(minute_text_layer, s_minute_buffer);
-	
-  snprintf(s_second_buffer, sizeof(s_second_buffer), "%d", seconds);
-  text_layer_set_text(second_text_layer, s_second_buffer);
+  // Only marked dirty when a digit changes, and marks made by several
+  // clicks before the next frame are drawn together in that frame
+	digit_layer_set_time(digit_layer, minutes, seconds);
+	PROFILE_END();
 }
 
 
@@ -156,70 +155,19 @@ static void initSetTextLayer(){
 	
 	// Initiate window layer
   Layer *window_layer = window_get_root_layer(window);
-  GRect window_bounds = layer_get_bounds(window_layer);
-	field_to_edit = MINUTES;
-	
-	// Create minute text layer and add it to the window layer
-	// ====================================
-	
-	// wrapper for minutes
-  minute_text_wrapper = text_layer_create((GRect) { .origin = { 0, 0 }, .size = { window_bounds.size.w, window_bounds.size.h/2 } });
-  text_layer_set_text_alignment(minute_text_wrapper, GTextAlignmentRight);
-	setTextLayerTheme(minute_text_wrapper, DARK);
-	//text_layer_set_background_color(minute_text_wrapper, GColorBlack);
-	//text_layer_set_text_color(minute_text_wrapper, GColorWhite);
-  layer_add_child(window_layer, text_layer_get_layer(minute_text_wrapper));
-	
-	// Actuall minutes text
-  minute_text_layer = text_layer_create((GRect) { .origin = { -10, 10 }, .size = { window_bounds.size.w - 30, window_bounds.size.h/2 } });
-  text_layer_set_text_alignment(minute_text_layer, GTextAlignmentRight);
-	setTextLayerTheme(minute_text_layer, DARK);
-	//text_layer_set_background_color(minute_text_layer, GColorBlack);
-	//text_layer_set_text_color(minute_text_layer, GColorWhite);
-	text_layer_set_font(minute_text_layer, fonts_get_system_font(FONT_KEY_BITHAM_42_BOLD));
-  layer_add_child(window_layer, text_layer_get_layer(minute_text_layer));
-	
-	
-	// wrapper for seconds
-  second_text_wrapper = text_layer_create((GRect) { .origin = { 0, window_bounds.size.h/2  }, .size = { window_bounds.size.w, window_bounds.size.h/2 } });
-  text_layer_set_text_alignment(second_text_wrapper, GTextAlignmentRight);
-	setTextLayerTheme(second_text_wrapper, LIGHT);
-  //text_layer_set_background_color(second_text_wrapper, GColorWhite);
-	//text_layer_set_text_color(second_text_wrapper, GColorBlack);
-  layer_add_child(window_layer, text_layer_get_layer(second_text_wrapper));
-	
-	// Create second text layer and add it to the window layer
-  second_text_layer = text_layer_create((GRect) { .origin = { -10, window_bounds.size.h/2 }, .size = { window_bounds.size.w - 30, window_bounds.size.h/2 } });
-  text_layer_set_text_alignment(second_text_layer, GTextAlignmentRight);
-	setTextLayerTheme(second_text_layer, LIGHT);
-	//text_layer_set_background_color(second_text_layer, GColorWhite);
-	//text_layer_set_text_color(second_text_layer, GColorBlack);
-	text_layer_set_font(second_text_layer, fonts_get_system_font(FONT_KEY_BITHAM_42_LIGHT));
-  layer_add_child(window_layer, text_layer_get_layer(second_text_layer));
-	
 	
+	// One layer draws both fields and the highlight
+	digit_layer = digit_layer_create(LAYOUT_DIGIT_FRAME, LAYOUT_DIGIT_INSET);
+  layer_add_child(window_layer, digit_layer_get_layer(digit_layer));
 }
 	
-static void window_load(Window *window)
+// Build every layer, only done the first time the window is needed
+static void buildWindow()
 {
-
-	
-	// Set value of time
-	switch(s_time_to_be_set){
-		case SET_TIMER_START_WINDOW: 
-			timer_set_time = persist_exists(TIMER_START_TIME) ? persist_read_int(TIMER_START_TIME) : DEFAULT_TIMER_START_TIME;
-		break;
-		case SET_TIMER_INTERVAL_WINDOW: 
-			timer_set_time = persist_exists(INTERVAL_TIME) ? persist_read_int(INTERVAL_TIME) : DEFAULT_INTERVAL_TIME;
-		break;
-		case SET_FINAL_WARNING_WINDOW: 
-			timer_set_time = persist_exists(FINAL_WARNING_TIME) ? persist_read_int(FINAL_WARNING_TIME) : DEFAULT_FINAL_WARNING_TIME;
-		break;
-	}
+	PROFILE_BEGIN(PROFILE_WINDOW_LOAD);
 	
 	// Set text in text layer
 	initSetTextLayer();
-	updateSetTextLayer();
 	
 	// Set the action bar
 	// ====================================
@@ -232,10 +180,10 @@ static void window_load(Window *window)
   action_bar_layer_set_click_config_provider(action_bar,
                                              click_config_provider);
 
-	// Load the icons
-	my_icon_plus = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_PLUS2);
-	my_icon_minus = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_MINUS2);
-	my_icon_settings = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_SWITCH);
+	// Load the icons, kept with the window until exit. None are shared with the timer window.
+	my_icon_plus = icon_cache_acquire(RESOURCE_ID_IMAGE_PLUS2);
+	my_icon_minus = icon_cache_acquire(RESOURCE_ID_IMAGE_MINUS2);
+	my_icon_settings = icon_cache_acquire(RESOURCE_ID_IMAGE_SWITCH);
 	
   // Set the icons:
   // The loading of the icons is omitted for brevity... See gbitmap_create_with_resource()
@@ -243,19 +191,28 @@ static void window_load(Window *window)
   action_bar_layer_set_icon(action_bar, BUTTON_ID_SELECT, my_icon_settings);
   action_bar_layer_set_icon(action_bar, BUTTON_ID_DOWN, my_icon_minus);
 	
+	PROFILE_END();
 }
 
-static void window_unload(Window *window)
+// Point the window at the setting being edited
+static void bindTime()
 {
-	/*
-	Do this for all layers:
-	text_layer_destroy(text_layer);
-	*/
-	text_layer_destroy(minute_text_wrapper);
-	text_layer_destroy(minute_text_layer);
-	text_layer_destroy(second_text_wrapper);
-	text_layer_destroy(second_text_layer);
-	window_destroy(window);
+	// Set value of time
+	const TimrSettings *settings = settings_get();
+	switch(s_time_to_be_set){
+		case SET_TIMER_START_WINDOW: 
+			timer_set_time = settings->timer_start_time;
+		break;
+		case SET_TIMER_INTERVAL_WINDOW: 
+			timer_set_time = settings->interval_time;
+		break;
+		case SET_FINAL_WARNING_WINDOW: 
+			timer_set_time = settings->final_warning_time;
+		break;
+	}
+	
+	setFieldToEdit(MINUTES);
+	updateSetTextLayer();
 }
 
 
@@ -263,19 +220,33 @@ static void window_unload(Window *window)
 	Window Initiation
 	========================================================================================
 */
-void set_time_window_init(int time_to_be_set)
+// The window is created once and kept across pushes, only the setting being edited is rebound
+Window* set_time_window_get(int time_to_be_set)
 {
 	s_time_to_be_set = time_to_be_set;
 	
-	window = window_create();
-
-	window_set_window_handlers(window, (WindowHandlers) {
-		.load = (WindowHandler) window_load,
-		.unload = (WindowHandler) window_unload
-	});
-
-
-	// window_set_click_config_provider(window, (ClickConfigProvider) registerButtons);
-	window_stack_push(window, true);
+	if(window == NULL){
+		window = window_create();
+		buildWindow();
+	}
+	
+	bindTime();
+	return window;
 }
 
+void set_time_window_deinit()
+{
+	if(window == NULL)
+		return;
+	
+	digit_layer_destroy(digit_layer);
+	action_bar_layer_destroy(action_bar);
+	
+	// Give the icons back to the cache
+	icon_cache_release(RESOURCE_ID_IMAGE_PLUS2);
+	icon_cache_release(RESOURCE_ID_IMAGE_MINUS2);
+	icon_cache_release(RESOURCE_ID_IMAGE_SWITCH);
+	
+	window_destroy(window);
+	window = NULL;
+}
@@ -8,7 +8,8 @@
 #ifndef SECONDWINDOW_H_
 #define SECONDWINDOW_H_
 
-void set_time_window_init(int time_to_be_set);
+Window* set_time_window_get(int time_to_be_set);
+void set_time_window_deinit(void);
 void updateSetTextLayer(void);
 
 #endif /* FIRSTWINDOW_H_ */
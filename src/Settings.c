@@ -0,0 +1,107 @@
+#include <pebble.h>
+
+#include "Timr.h"
+#include "Settings.h"
+#include "Storage.h"
+#include "Presets.h"
+
+/*
+	Variables
+	========================================================================================
+*/
+// The one copy of the settings, loaded once at launch
+static TimrSettings s_settings;
+
+// Modules to tell when a setting is committed
+static SettingsChangedHandler s_subscribers[SETTINGS_MAX_SUBSCRIBERS];
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+static void notifySubscribers(){
+	for(int i = 0; i < SETTINGS_MAX_SUBSCRIBERS; i++){
+		if(s_subscribers[i])
+			s_subscribers[i](&s_settings);
+	}
+}
+
+// Read every setting from storage, only needed once per launch
+void settings_init(){
+	storage_load(&s_settings);
+}
+
+// Write changed settings, called when leaving the settings screens and at exit
+void settings_flush(){
+	storage_flush(&s_settings);
+}
+
+const TimrSettings* settings_get(){
+	return &s_settings;
+}
+
+// Commit a new value and tell subscribers, it is written on the next flush
+void settings_set(uint8_t setting_id, uint16_t value){
+	
+	uint16_t *setting;
+	
+	switch(setting_id){
+		case TIMER_START_TIME:
+			setting = &s_settings.timer_start_time;
+		break;
+		case INTERVAL_TIME:
+			setting = &s_settings.interval_time;
+		break;
+		case FINAL_WARNING_TIME:
+			setting = &s_settings.final_warning_time;
+		break;
+		case AGENDA_SELECTED:
+			setting = &s_settings.agenda;
+		break;
+		case PRESET_SELECTED:
+			setting = &s_settings.preset;
+		break;
+		default:
+			return;
+	}
+	
+	// Nothing to commit
+	if(*setting == value)
+		return;
+	
+	*setting = value;
+	
+	// Custom times take over from the preset
+	if(setting_id == TIMER_START_TIME || setting_id == INTERVAL_TIME || setting_id == FINAL_WARNING_TIME)
+		s_settings.preset = PRESET_NONE;
+	
+	notifySubscribers();
+}
+
+// A handler is only ever called once per change, subscribing it again does nothing
+bool settings_subscribe(SettingsChangedHandler handler){
+	int free_slot = -1;
+	
+	for(int i = 0; i < SETTINGS_MAX_SUBSCRIBERS; i++){
+		if(s_subscribers[i] == handler)
+			return true;
+		if(s_subscribers[i] == NULL && free_slot < 0)
+			free_slot = i;
+	}
+	
+	if(free_slot < 0){
+		APP_LOG(APP_LOG_LEVEL_ERROR, "Settings subscribers full, raise SETTINGS_MAX_SUBSCRIBERS");
+		return false;
+	}
+	
+	s_subscribers[free_slot] = handler;
+	return true;
+}
+
+void settings_unsubscribe(SettingsChangedHandler handler){
+	for(int i = 0; i < SETTINGS_MAX_SUBSCRIBERS; i++){
+		if(s_subscribers[i] == handler)
+			s_subscribers[i] = NULL;
+	}
+}
@@ -0,0 +1,32 @@
+/*
+ * Settings.h
+ */
+
+#ifndef SETTINGS_H_
+#define SETTINGS_H_
+
+#include <pebble.h>
+
+// Maximum number of modules that can listen for settings changes
+#define SETTINGS_MAX_SUBSCRIBERS 4
+
+// In memory copy of every persisted timer setting
+typedef struct {
+	uint16_t timer_start_time;
+	uint16_t interval_time;
+	uint16_t final_warning_time;
+	uint16_t agenda;
+	uint16_t preset;
+} TimrSettings;
+
+// Called after a setting has been committed
+typedef void (*SettingsChangedHandler)(const TimrSettings *settings);
+
+void settings_init(void);
+const TimrSettings* settings_get(void);
+void settings_set(uint8_t setting_id, uint16_t value);
+void settings_flush(void);
+bool settings_subscribe(SettingsChangedHandler handler);
+void settings_unsubscribe(SettingsChangedHandler handler);
+
+#endif /* SETTINGS_H_ */
@@ -0,0 +1,164 @@
+#include <pebble.h>
+
+#include "Timr.h"
+#include "Storage.h"
+#include "PowerStats.h"
+
+/*
+	Definitions
+	========================================================================================
+*/
+// Everything in SETTINGS_RECORD, the checksum covers every byte after it.
+// Fields are only ever added to the end, older versions are a prefix.
+typedef struct __attribute__((__packed__)) {
+	uint8_t version;
+	uint8_t checksum;
+	uint16_t timer_start_time;
+	uint16_t interval_time;
+	uint16_t final_warning_time;
+	uint16_t agenda;
+	uint32_t write_count;
+	uint8_t preset;
+} SettingsRecord;
+
+// Length of a version 1 record, from before presets
+#define RECORD_V1_LENGTH offsetof(SettingsRecord, preset)
+
+
+/*
+	Variables
+	========================================================================================
+*/
+// What is in flash right now, so writes that change nothing can be skipped
+static SettingsRecord s_stored;
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+static uint8_t checksum(const SettingsRecord *record, size_t length){
+	const uint8_t *bytes = (const uint8_t *) record;
+	uint8_t sum = 0;
+	
+	for(size_t i = offsetof(SettingsRecord, timer_start_time); i < length; i++)
+		sum = (sum << 1 | sum >> 7) ^ bytes[i];
+	
+	return sum;
+}
+
+static void toRecord(const TimrSettings *settings, SettingsRecord *record){
+	record->version = STORAGE_VERSION;
+	record->timer_start_time = settings->timer_start_time;
+	record->interval_time = settings->interval_time;
+	record->final_warning_time = settings->final_warning_time;
+	record->agenda = settings->agenda;
+	record->preset = settings->preset;
+}
+
+static void fromRecord(const SettingsRecord *record, TimrSettings *settings){
+	settings->timer_start_time = record->timer_start_time;
+	settings->interval_time = record->interval_time;
+	settings->final_warning_time = record->final_warning_time;
+	settings->agenda = record->agenda;
+	settings->preset = record->preset;
+}
+
+static uint16_t readLegacy(uint32_t key, uint16_t default_value, bool *found){
+	if(!persist_exists(key))
+		return default_value;
+	
+	*found = true;
+	STATS_COUNT(STAT_PERSIST_READ);
+	return persist_read_int(key);
+}
+
+// Copy the one key per setting layout into the settings, true if any old key was there
+static bool migrate(TimrSettings *settings){
+	bool found = false;
+	
+	settings->timer_start_time = readLegacy(LEGACY_TIMER_START_TIME, DEFAULT_TIMER_START_TIME, &found);
+	settings->interval_time = readLegacy(LEGACY_INTERVAL_TIME, DEFAULT_INTERVAL_TIME, &found);
+	settings->final_warning_time = readLegacy(LEGACY_FINAL_WARNING_TIME, DEFAULT_FINAL_WARNING_TIME, &found);
+	settings->agenda = readLegacy(LEGACY_AGENDA_SELECTED, DEFAULT_AGENDA_SELECTED, &found);
+	settings->preset = DEFAULT_PRESET_SELECTED;
+	
+	return found;
+}
+
+// The old keys only go once the record holding their values reads back whole,
+// otherwise they are still there to migrate from next launch
+static void deleteLegacy(){
+	SettingsRecord record;
+	
+	STATS_COUNT(STAT_PERSIST_READ);
+	if(persist_read_data(SETTINGS_RECORD, &record, sizeof(record)) != sizeof(record) || memcmp(&record, &s_stored, sizeof(record)) != 0){
+		APP_LOG(APP_LOG_LEVEL_WARNING, "Settings not stored, old keys kept");
+		return;
+	}
+	
+	static const uint32_t keys[] = { LEGACY_TIMER_START_TIME, LEGACY_INTERVAL_TIME, LEGACY_FINAL_WARNING_TIME, LEGACY_AGENDA_SELECTED };
+	for(size_t i = 0; i < ARRAY_LENGTH(keys); i++){
+		persist_delete(keys[i]);
+		STATS_COUNT(STAT_PERSIST_WRITE);
+	}
+}
+
+// Read every setting in one go, migrating old keys or falling back to defaults.
+// Defaults are not written until something changes.
+void storage_load(TimrSettings *settings){
+	
+	STATS_COUNT(STAT_PERSIST_READ);
+	int read = persist_read_data(SETTINGS_RECORD, &s_stored, sizeof(s_stored));
+	
+	if(read == sizeof(s_stored) && s_stored.version == STORAGE_VERSION && s_stored.checksum == checksum(&s_stored, read)){
+		fromRecord(&s_stored, settings);
+		return;
+	}
+	
+	// A version 1 record has no preset, it is rewritten as the current version on the next flush
+	if(read == (int) RECORD_V1_LENGTH && s_stored.version == 1 && s_stored.checksum == checksum(&s_stored, read)){
+		s_stored.preset = DEFAULT_PRESET_SELECTED;
+		fromRecord(&s_stored, settings);
+		return;
+	}
+	
+	// Anything else is treated as never having been stored
+	uint32_t write_count = (read >= (int) RECORD_V1_LENGTH) ? s_stored.write_count : 0;
+	memset(&s_stored, 0, sizeof(s_stored));
+	s_stored.write_count = write_count;
+	
+	// Old keys are stored as a record straight away, then deleted.
+	// Defaults count as stored so the first flush doesn't write them.
+	if(migrate(settings)){
+		if(storage_flush(settings))
+			deleteLegacy();
+	}else{
+		toRecord(settings, &s_stored);
+	}
+}
+
+// Write the settings if they differ from what is stored, returns true if a write happened
+bool storage_flush(const TimrSettings *settings){
+	
+	SettingsRecord record = s_stored;
+	toRecord(settings, &record);
+	
+	if(memcmp(&record, &s_stored, sizeof(record)) == 0)
+		return false;
+	
+	record.write_count++;
+	record.checksum = checksum(&record, sizeof(record));
+	
+	if(persist_write_data(SETTINGS_RECORD, &record, sizeof(record)) < 0)
+		return false;
+	
+	STATS_COUNT(STAT_PERSIST_WRITE);
+	s_stored = record;
+	return true;
+}
+
+// How many times the record has been written, over the life of the app
+uint32_t storage_write_count(){
+	return s_stored.write_count;
+}
@@ -0,0 +1,18 @@
+/*
+ * Storage.h
+ */
+
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+#include <pebble.h>
+
+#include "Settings.h"
+
+#define STORAGE_VERSION 2
+
+void storage_load(TimrSettings *settings);
+bool storage_flush(const TimrSettings *settings);
+uint32_t storage_write_count(void);
+
+#endif /* STORAGE_H_ */
@@ -0,0 +1,356 @@
+#include <pebble.h>
+
+#include "Timr.h"
+#include "TimerCore.h"
+#include "Settings.h"
+#include "Countdown.h"
+#include "Cues.h"
+#include "Agenda.h"
+#include "Presets.h"
+#include "Profiler.h"
+
+/*
+	Variables
+	========================================================================================
+*/
+// What views get to read
+static TimerState s_state;
+
+// Anchored to the wall clock, s_state.time is worked out from it on every advance
+static Countdown s_countdown;
+
+// Every cue of the segment, rebuilt when the settings or segment change
+static CueTimeline s_timeline;
+
+// Selected agenda and preset, NULL when not selected
+static const Agenda *s_agenda;
+static const Preset *s_preset;
+
+// Views and services to tell when something changes, the core itself plays
+// and stores nothing
+static TimerEventHandler s_subscribers[TIMER_CORE_MAX_SUBSCRIBERS];
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+static void notifySubscribers(TimerEventType event){
+	for(int i = 0; i < TIMER_CORE_MAX_SUBSCRIBERS; i++){
+		if(s_subscribers[i])
+			s_subscribers[i](event);
+	}
+}
+
+// Tell subscribers a cue was passed
+static void notifyCue(CueType type){
+	s_state.cue = type;
+	notifySubscribers(TIMER_EVENT_CUE);
+}
+
+// Note what is about to change, with the segment and time it happened at
+static void setChange(TimerChange change, int time){
+	s_state.change = change;
+	s_state.change_segment = s_state.segment;
+	s_state.change_time = time;
+}
+
+// Take the times of the current segment, or the preset or settings when there is no agenda
+static void loadSegment(){
+	const TimrSettings *settings = settings_get();
+	
+	if(s_agenda){
+		if(s_state.segment >= s_agenda->num_segments)
+			s_state.segment = 0;
+		
+		const AgendaSegment *current = &s_agenda->segments[s_state.segment];
+		s_state.timer_start_time = current->duration;
+		s_state.interval_time = current->interval_time;
+		s_state.final_warning_time = current->final_warning_time;
+	}else if(s_preset){
+		s_state.segment = 0;
+		s_state.timer_start_time = s_preset->timer_start_time;
+		s_state.interval_time = s_preset->interval_time;
+		s_state.final_warning_time = s_preset->final_warning_time;
+	}else{
+		s_state.segment = 0;
+		s_state.timer_start_time = settings->timer_start_time;
+		s_state.interval_time = settings->interval_time;
+		s_state.final_warning_time = settings->final_warning_time;
+	}
+	
+	// Cues only change with the settings or segment
+	cues_build(&s_timeline, s_state.timer_start_time, s_state.interval_time, s_state.final_warning_time);
+}
+
+// Stop at the start of the first segment
+static void resetTime(){
+	if(s_state.segment != 0){
+		s_state.segment = 0;
+		loadSegment();
+	}
+	
+	countdown_reset(&s_countdown, s_state.timer_start_time);
+	s_state.running = false;
+	s_state.overtime = false;
+	s_state.time = s_state.timer_start_time;
+	cues_seek(&s_timeline, s_state.time);
+}
+
+// Carry on into the next segment of the agenda, false if there is none.
+// Everything is already in memory so nothing is reloaded.
+static bool nextSegment(){
+	if(s_agenda == NULL || s_state.segment + 1 >= s_agenda->num_segments)
+		return false;
+	
+	s_state.segment++;
+	loadSegment();
+	
+	countdown_chain(&s_countdown, s_state.timer_start_time);
+	s_state.time = countdown_remaining(&s_countdown);
+	cues_seek(&s_timeline, s_state.time);
+	return true;
+}
+
+// The time is up, keep counting on from zero until it is stopped
+static void startOvertime(){
+	s_state.overtime = true;
+	s_state.time = 0;
+	s_state.overtime_time = countdown_overtime_ms(&s_countdown) / 1000;
+}
+
+// Catch the overtime up, with a cue every OVERTIME_CUE_TIME seconds past zero
+static void advanceOvertime(){
+	int last_overtime = s_state.overtime_time;
+	s_state.overtime_time = countdown_overtime_ms(&s_countdown) / 1000;
+	
+	if(s_state.overtime_time > OVERTIME_MAX){
+		timer_core_stop();
+		return;
+	}
+	
+	if(s_state.overtime_time / OVERTIME_CUE_TIME > last_overtime / OVERTIME_CUE_TIME)
+		notifyCue(CUE_OVERTIME);
+	
+	if(s_state.overtime_time != last_overtime)
+		notifySubscribers(TIMER_EVENT_TIME);
+}
+
+// Pick up settings committed by SetTimeWindow or the menu, any change resets the timer
+static void settings_changed_handler(const TimrSettings *settings){
+	
+	s_agenda = agenda_get(settings->agenda);
+	s_preset = preset_get(settings->preset);
+	s_state.segment = 0;
+	loadSegment();
+	
+	resetTime();
+	setChange(TIMER_CHANGE_RESET, s_state.time);
+	notifySubscribers(TIMER_EVENT_STATE);
+}
+
+
+/*
+	Events
+	========================================================================================
+*/
+void timer_core_start(){
+	if(s_state.running)
+		return;
+	
+	// A fresh start, or carrying on after a pause
+	bool fresh = s_state.segment == 0 && countdown_remaining_ms(&s_countdown) == (int32_t) s_state.timer_start_time * 1000;
+	setChange(fresh ? TIMER_CHANGE_START : TIMER_CHANGE_RESUME, s_state.time);
+	
+	countdown_start(&s_countdown);
+	s_state.running = true;
+	notifySubscribers(TIMER_EVENT_STATE);
+}
+
+// Nothing to pause once the time is up
+void timer_core_pause(){
+	if(!s_state.running || s_state.overtime)
+		return;
+	
+	countdown_pause(&s_countdown);
+	s_state.running = false;
+	s_state.time = countdown_remaining(&s_countdown);
+	setChange(TIMER_CHANGE_PAUSE, s_state.time);
+	notifySubscribers(TIMER_EVENT_STATE);
+}
+
+// Stop and go back to the start
+void timer_core_stop(){
+	if(s_state.running)
+		setChange(TIMER_CHANGE_STOP, s_state.overtime ? countdown_overtime_ms(&s_countdown) / 1000 : s_state.time);
+	else
+		setChange(TIMER_CHANGE_RESET, s_state.time);
+	
+	resetTime();
+	notifySubscribers(TIMER_EVENT_STATE);
+}
+
+// Go back to the start, keeps running if it was
+void timer_core_restart(){
+	bool running = s_state.running;
+	
+	setChange(TIMER_CHANGE_RESTART, s_state.time);
+	resetTime();
+	
+	if(running){
+		countdown_start(&s_countdown);
+		s_state.running = true;
+	}
+	notifySubscribers(TIMER_EVENT_STATE);
+}
+
+// Catch up with the clock, playing any cue passed and moving through segments
+void timer_core_advance(){
+	if(!s_state.running)
+		return;
+	
+	if(s_state.overtime){
+		advanceOvertime();
+		return;
+	}
+	
+	// Work out the time left from the end time, late or missed wakes can't add error
+	int last_time = s_state.time;
+	s_state.time = countdown_remaining(&s_countdown);
+	
+	// Only the next cue needs checking, play the strongest one passed since the last advance
+	const Cue *cue = cues_peek(&s_timeline);
+	if(cue && s_state.time <= cue->remaining){
+		PROFILE_CUE_LATE(cue->remaining * 1000 - countdown_remaining_ms(&s_countdown));
+		notifyCue(cues_advance(&s_timeline, s_state.time));
+	}
+	
+	if(s_state.time <= 0){
+		if(nextSegment()){
+			notifySubscribers(TIMER_EVENT_SEGMENT);
+		}else{
+			// Count on past zero instead of resetting, so running over is obvious
+			setChange(TIMER_CHANGE_TIME_UP, 0);
+			startOvertime();
+			notifySubscribers(TIMER_EVENT_STATE);
+			return;
+		}
+	}
+	
+	if(s_state.time != last_time)
+		notifySubscribers(TIMER_EVENT_TIME);
+}
+
+// Time until the next cue, segment or overtime cue is due, -1 if there is none
+int32_t timer_core_next_event_ms(){
+	if(!s_state.running)
+		return -1;
+	
+	if(s_state.overtime)
+		return OVERTIME_CUE_TIME * 1000 - countdown_overtime_ms(&s_countdown) % (OVERTIME_CUE_TIME * 1000);
+	
+	return cues_ms_until_next(&s_timeline, countdown_remaining_ms(&s_countdown));
+}
+
+int32_t timer_core_remaining_ms(){
+	return countdown_remaining_ms(&s_countdown);
+}
+
+int32_t timer_core_overtime_ms(){
+	return countdown_overtime_ms(&s_countdown);
+}
+
+const TimerState* timer_core_get(){
+	return &s_state;
+}
+
+// Cues of the current segment, for drawing them and handing them to the background
+const CueTimeline* timer_core_timeline(){
+	return &s_timeline;
+}
+
+const Countdown* timer_core_countdown(){
+	return &s_countdown;
+}
+
+
+/*
+	Subscriptions
+	========================================================================================
+*/
+// A handler is only ever called once per event, subscribing it again does nothing
+bool timer_core_subscribe(TimerEventHandler handler){
+	int free_slot = -1;
+	
+	for(int i = 0; i < TIMER_CORE_MAX_SUBSCRIBERS; i++){
+		if(s_subscribers[i] == handler)
+			return true;
+		if(s_subscribers[i] == NULL && free_slot < 0)
+			free_slot = i;
+	}
+	
+	if(free_slot < 0){
+		APP_LOG(APP_LOG_LEVEL_ERROR, "Timer subscribers full, raise TIMER_CORE_MAX_SUBSCRIBERS");
+		return false;
+	}
+	
+	s_subscribers[free_slot] = handler;
+	return true;
+}
+
+void timer_core_unsubscribe(TimerEventHandler handler){
+	for(int i = 0; i < TIMER_CORE_MAX_SUBSCRIBERS; i++){
+		if(s_subscribers[i] == handler)
+			s_subscribers[i] = NULL;
+	}
+}
+
+
+/*
+	Init and Deinit
+	========================================================================================
+*/
+// Load the timer from the settings
+void timer_core_init(){
+	settings_changed_handler(settings_get());
+	settings_subscribe(settings_changed_handler);
+}
+
+void timer_core_deinit(){
+	settings_unsubscribe(settings_changed_handler);
+}
+
+// Carry on with a countdown that kept running while the app was closed
+void timer_core_resume(const Countdown *countdown, uint8_t segment){
+	s_countdown = *countdown;
+	s_state.segment = segment;
+	s_state.running = true;
+	loadSegment();
+	
+	// Catch up on segments that ended while the app was closed
+	while(countdown_remaining_ms(&s_countdown) == 0 && nextSegment())
+		notifySubscribers(TIMER_EVENT_SEGMENT);
+	
+	// Ran out while closed, carry on in overtime unless that has run out too
+	if(countdown_overtime_ms(&s_countdown) / 1000 > OVERTIME_MAX){
+		resetTime();
+	}else if(countdown_remaining_ms(&s_countdown) == 0){
+		startOvertime();
+	}else{
+		s_state.time = countdown_remaining(&s_countdown);
+		cues_seek(&s_timeline, s_state.time);
+	}
+}
+
+// Pass the cues of the last few seconds again, for a launch that came to play them
+void timer_core_replay_cues(int seconds){
+	if(!s_state.running)
+		return;
+	
+	int time = s_state.overtime ? 0 : s_state.time;
+	
+	cues_seek(&s_timeline, time + seconds + 1);
+	CueType type = cues_advance(&s_timeline, time);
+	if(type != CUE_NONE)
+		notifyCue(type);
+}
@@ -0,0 +1,78 @@
+/*
+ * TimerCore.h
+ */
+
+#ifndef TIMERCORE_H_
+#define TIMERCORE_H_
+
+#include <pebble.h>
+
+#include "Countdown.h"
+#include "Cues.h"
+
+// Maximum number of views and services that can listen for timer events. VibePatterns,
+// SessionLog, Presenter and TimerWindow take four, the rest are spare.
+#define TIMER_CORE_MAX_SUBSCRIBERS 6
+
+// Overtime stops counting once the minutes run out of digits
+#define OVERTIME_MAX (99 * 60 + 59)
+
+// What changed, sent to subscribers
+typedef enum {
+	TIMER_EVENT_TIME,     // The whole seconds left (or past zero) changed
+	TIMER_EVENT_CUE,      // A cue was passed, timer_core_get()->cue says which
+	TIMER_EVENT_SEGMENT,  // The next agenda segment started
+	TIMER_EVENT_STATE     // Started, paused, reset or went into overtime
+} TimerEventType;
+
+typedef void (*TimerEventHandler)(TimerEventType event);
+
+// What a TIMER_EVENT_STATE was for
+typedef enum {
+	TIMER_CHANGE_RESET,   // Loaded the settings, or stopped while already stopped
+	TIMER_CHANGE_START,
+	TIMER_CHANGE_RESUME,
+	TIMER_CHANGE_PAUSE,
+	TIMER_CHANGE_STOP,
+	TIMER_CHANGE_RESTART,
+	TIMER_CHANGE_TIME_UP
+} TimerChange;
+
+// Everything a view needs to draw the timer, as of the last call into the core
+typedef struct {
+	bool running;
+	bool overtime;
+	int time;             // Whole seconds left, rounded up
+	int overtime_time;    // Whole seconds past zero, in overtime
+	uint8_t segment;
+	uint16_t timer_start_time;
+	uint16_t interval_time;
+	uint16_t final_warning_time;
+	CueType cue;             // Strongest cue passed, for TIMER_EVENT_CUE
+	TimerChange change;      // What the last TIMER_EVENT_STATE was for
+	uint8_t change_segment;  // Segment and seconds left (or past zero) just before it
+	int change_time;
+} TimerState;
+
+void timer_core_init(void);
+void timer_core_deinit(void);
+const TimerState* timer_core_get(void);
+const CueTimeline* timer_core_timeline(void);
+const Countdown* timer_core_countdown(void);
+void timer_core_resume(const Countdown *countdown, uint8_t segment);
+void timer_core_replay_cues(int seconds);
+
+void timer_core_start(void);
+void timer_core_pause(void);
+void timer_core_stop(void);
+void timer_core_restart(void);
+void timer_core_advance(void);
+
+int32_t timer_core_next_event_ms(void);
+int32_t timer_core_remaining_ms(void);
+int32_t timer_core_overtime_ms(void);
+
+bool timer_core_subscribe(TimerEventHandler handler);
+void timer_core_unsubscribe(TimerEventHandler handler);
+
+#endif /* TIMERCORE_H_ */
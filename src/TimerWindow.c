@@ -1,11 +1,27 @@
 #include <pebble.h>
-#include <pebble_fonts.h>
 
 #include "Timr.h"
 #include "TimerWindow.h"
+#include "TimerCore.h"
+#include "Settings.h"
+#include "Scheduler.h"
+#include "DigitLayer.h"
+#include "ProgressLayer.h"
+#include "Layout.h"
+#include "IconCache.h"
+#include "PowerStats.h"
+#include "Profiler.h"
 
 
 
+/*
+	Definitions
+	========================================================================================
+*/
+// The icons load this long after the window, once the digits are on screen
+#define DEFERRED_LOAD_MS 50
+
+
 /*
 	Variables
 	========================================================================================
@@ -14,32 +30,37 @@
 // The window
 static Window *window;
 
-// Where text will show up
-static TextLayer *text_layer;
-static TextLayer *minute_text_layer;
-static TextLayer *second_text_layer;
+// Where the time will show up
+static DigitLayer *digit_layer;
+
+// Elapsed time and cue marks, the segment its tables were built for
+static ProgressLayer *progress_layer;
+static uint8_t progress_segment;
+static bool progress_stale;
 
 // The action bar
-ActionBarLayer *action_bar;
+static ActionBarLayer *action_bar;
 static GBitmap *my_icon_play;
 static GBitmap *my_icon_pause;
 static GBitmap *my_icon_settings;
 static GBitmap *my_icon_restart;
+static AppTimer *icon_timer;
+static bool icons_loaded;
 
-// To keep track of timer_running state
-static bool timer_running;
+// Only wake up while the timer is on screen
+static bool window_visible;
 
-// To keep track of time
-static int s_time = 0;
+// A tap shows the seconds while they are otherwise left off
+static bool peeking;
+static AppTimer *peek_timer;
+static bool tap_subscribed;
 
-static uint16_t timer_start_time;
-static uint16_t interval_time;
-static uint16_t final_warning_time;
-static uint16_t check_time;
+// Low battery keeps the seconds off for longer
+static bool battery_low;
 
-// Bool to test if menu was opened (i.e. update start time)
-static bool menu_was_opened;
 
+static void updateSchedule(void);
+static void updatePlayIcon(void);
 
 /*
 	Button Callbacks
@@ -53,32 +74,25 @@ static void button_back_single(ClickRecognizerRef recognizer, void* context)
 
 static void center_click_handler(ClickRecognizerRef recognizer, void* context)
 {
-	if(timer_running){
-		stopTimer();
-	}
-	
-	menu_was_opened = true;
+	timer_core_stop();
 	switchWindow(MENU_WINDOW);
 }
 
 static void up_click_handler(ClickRecognizerRef recognizer, void *context) {
+	const TimerState *timer = timer_core_get();
 	
-	if(timer_running == false){
-  	action_bar_layer_set_icon(action_bar, BUTTON_ID_UP, my_icon_pause);
-		timer_running = (bool) true;
-		// start the clock
-	}else{
-  	action_bar_layer_set_icon(action_bar, BUTTON_ID_UP, my_icon_play);
-		timer_running = (bool) false;
-		// pause the clock
-	}
-	
+	// Nothing to pause once the time is up, this acknowledges it instead
+	if(timer->overtime)
+		timer_core_stop();
+	else if(timer->running)
+		timer_core_pause();
+	else
+		timer_core_start();
 }
 
 static void down_click_handler(ClickRecognizerRef recognizer, void *context) {
-	// restart the clock
-	s_time = timer_start_time;
-
+	// restart the clock, keeps running if it was
+	timer_core_restart();
 }
 
 static void click_config_provider(void *context) {
@@ -93,84 +107,217 @@ static void click_config_provider(void *context) {
 	Logic and Operations
 	========================================================================================
 */
-// Stops timer and resets ui
-void stopTimer(){
+// Play or pause on the up button, left empty until the icons have loaded
+static void updatePlayIcon(){
+	if(icons_loaded)
+		action_bar_layer_set_icon(action_bar, BUTTON_ID_UP, timer_core_get()->running ? my_icon_pause : my_icon_play);
+}
+
+
+/*
+	Refresh Policy
+	========================================================================================
+*/
+// Seconds left when the seconds come on screen by themselves
+static int secondsTime(){
+	uint16_t final_warning_time = timer_core_get()->final_warning_time;
+	
+	if(battery_low)
+		return final_warning_time;
 	
-	s_time = timer_start_time;
-  action_bar_layer_set_icon(action_bar, BUTTON_ID_UP, my_icon_play);
-	timer_running = (bool) false;
+	return final_warning_time > SECONDS_TIME ? final_warning_time : SECONDS_TIME;
+}
+
+// Whether the seconds are worth drawing without a peek. A stopped timer shows
+// everything, a running one only near the end and never in overtime.
+static bool secondsNeeded(){
+	const TimerState *timer = timer_core_get();
+	
+	if(timer->overtime)
+		return false;
+	
+	return !timer->running || timer->time <= secondsTime();
+}
+
+static bool showSeconds(){
+	return peeking || secondsNeeded();
+}
+
+static void peek_timer_callback(void *data){
+	peek_timer = NULL;
+	peeking = false;
 	
 	updateTextLayer();
+	updateSchedule();
 }
 
-// Set UI elements
-void updateTextLayer(){
+// A tap shows the seconds for a while, every tap starts the while over
+static void tap_handler(AccelAxisType axis, int32_t direction){
+	if(peek_timer == NULL || !app_timer_reschedule(peek_timer, PEEK_TIME_MS))
+		peek_timer = app_timer_register(PEEK_TIME_MS, peek_timer_callback, NULL);
 	
-  // Use a long-lived buffer
-  static char s_minute_buffer[32];
-  static char s_second_buffer[32];
+	peeking = true;
+	timer_core_advance();
+	
+	updateTextLayer();
+	updateSchedule();
+}
 
-  // Get time since launch
-  int seconds = s_time % 60;
-  int minutes = (s_time % 3600) / 60;
+static void stopPeek(){
+	peeking = false;
+	if(peek_timer){
+		app_timer_cancel(peek_timer);
+		peek_timer = NULL;
+	}
+}
 
-  // Update the TextLayer
-  snprintf(s_minute_buffer, sizeof(s_minute_buffer), "%d", minutes);
-  text_layer_set_text(minute_text_layer, s_minute_buffer);
+// Taps are only listened for while there are seconds to peek at
+static void updateTapService(bool listen){
+	if(listen == tap_subscribed)
+		return;
 	
-  snprintf(s_second_buffer, sizeof(s_second_buffer), "%d", seconds);
-  text_layer_set_text(second_text_layer, s_second_buffer);
+	if(listen)
+		accel_tap_service_subscribe(tap_handler);
+	else
+		accel_tap_service_unsubscribe();
+	
+	tap_subscribed = listen;
 }
 
+static void battery_handler(BatteryChargeState state){
+	bool low = state.charge_percent <= LOW_BATTERY_PERCENT && !state.is_charging;
+	if(low == battery_low)
+		return;
+	
+	battery_low = low;
+	updateTextLayer();
+	updateSchedule();
+}
+
+// Which tick unit the display needs. With the seconds off the screen only
+// changes once a minute, so it wakes on its own timer instead of ticking.
+static TimeUnits displayUnit(){
+	return showSeconds() ? SECOND_UNIT : SCHEDULER_NO_TICKS;
+}
 
-// Manage what happens while the timer is running
-static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
+// Time until the minutes on screen change, the core has something due or the seconds come on
+static int32_t msUntilNextChange(){
+	int32_t ms;
 	
-	// Check if start time has changed
-	check_time = persist_exists(TIMER_START_TIME) ? persist_read_int(TIMER_START_TIME) : DEFAULT_TIMER_START_TIME;
-	if(check_time != timer_start_time){
-		timer_start_time = check_time;
-		s_time = timer_start_time;
+	if(timer_core_get()->overtime){
+		ms = 60000 - timer_core_overtime_ms() % 60000;
+	}else{
+		int32_t remaining_ms = timer_core_remaining_ms();
+		ms = (remaining_ms - 1) % 60000 + 1;
+		
+		int32_t seconds_ms = remaining_ms - secondsTime() * 1000;
+		if(seconds_ms > 0 && seconds_ms < ms)
+			ms = seconds_ms;
 	}
 	
-	// Check if interval time has changed
-	check_time = persist_exists(INTERVAL_TIME) ? persist_read_int(INTERVAL_TIME) : DEFAULT_INTERVAL_TIME;
-	if(check_time != interval_time){
-		interval_time = check_time;
-		s_time = timer_start_time;
+	int32_t event_ms = timer_core_next_event_ms();
+	if(event_ms >= 0 && event_ms < ms)
+		ms = event_ms;
+	
+	return ms;
+}
+
+// Sleep unless the timer is both running and visible
+static void updateSchedule(){
+	bool awake = timer_core_get()->running && window_visible;
+	TimeUnits unit = displayUnit();
+	
+	scheduler_update(awake, unit);
+	updateTapService(awake && !secondsNeeded());
+	
+	if(!awake)
+		return;
+
+	// Ticks land on every second of the wall clock, not of the countdown,
+	// so cues still get their own wake to play on time
+	if(unit != SECOND_UNIT){
+		scheduler_wake_in(msUntilNextChange());
+	}else{
+		int32_t event_ms = timer_core_next_event_ms();
+		if(event_ms >= 0)
+			scheduler_wake_in(event_ms);
+		else
+			scheduler_cancel_wake();
 	}
+}
+
+// Tables are only rebuilt when the times change, otherwise a piece fills at a time
+static void updateProgress(){
+	const TimerState *timer = timer_core_get();
 	
-	// Check if final warning time has changed
-	check_time = persist_exists(FINAL_WARNING_TIME) ? persist_read_int(FINAL_WARNING_TIME) : DEFAULT_FINAL_WARNING_TIME;
-	if(check_time != final_warning_time){
-		final_warning_time = check_time;
-		s_time = timer_start_time;
+	if(progress_stale || timer->segment != progress_segment){
+		progress_layer_set_cues(progress_layer, timer_core_timeline(), timer->timer_start_time);
+		progress_segment = timer->segment;
+		progress_stale = false;
 	}
 	
-	if(timer_running){
+	progress_layer_set_elapsed(progress_layer, timer->overtime ? timer->timer_start_time : timer->timer_start_time - timer->time);
+}
+
+// Set UI elements
+void updateTextLayer(){
+	PROFILE_BEGIN(PROFILE_UPDATE_TEXT);
+	const TimerState *timer = timer_core_get();
+	
+	updateProgress();
+	
+	// Overtime counts up, seconds only while peeking
+	if(timer->overtime){
+		digit_layer_set_time(digit_layer, timer->overtime_time / 60, peeking ? timer->overtime_time % 60 : DIGIT_HIDDEN);
+		PROFILE_END();
+		return;
+	}
+	
+	// Minutes only, rounded up so a minute is never shown as gone early
+	if(!showSeconds()){
+		digit_layer_set_time(digit_layer, (timer->time + 59) / 60, DIGIT_HIDDEN);
+		PROFILE_END();
+		return;
+	}
+	
+  // Get time since launch
+  int seconds = timer->time % 60;
+  int minutes = (timer->time % 3600) / 60;
 
-  	// Decrease the counter 
-		s_time--;
+  // Nothing is redrawn unless a digit changed
+	digit_layer_set_time(digit_layer, minutes, seconds);
+	PROFILE_END();
+}
+
+
+// The scheduler only wakes while the timer is visible, the core catches up on the time passed
+static void timer_wake_handler() {
+	PROFILE_BEGIN(PROFILE_WAKE);
+	
+	timer_core_advance();
+	
+	// Arm the next wake, or go to ticks once the seconds are needed
+	updateSchedule();
+	PROFILE_END();
+}
+
+// Only subscribed between appear and disappear, nothing is drawn while covered
+static void timer_event_handler(TimerEventType event){
+	
+	if(event == TIMER_EVENT_STATE){
+		const TimerState *timer = timer_core_get();
 		
-		// Vibrate if on interval time
-		if(s_time % interval_time == 0)
-			vibes_short_pulse();
+		// Inverted in overtime so it can't be mistaken for a countdown
+		digit_layer_set_highlight(digit_layer, timer->overtime ? DIGIT_ROW_ALL : DIGIT_ROW_NONE);
+		if(!timer->running)
+			stopPeek();
 		
-		if(s_time <= 0)
-			stopTimer();
+		updatePlayIcon();
+		updateSchedule();
 	}
 	
 	// Set UI elements
 	updateTextLayer();
-	
-	// If the menu was opened
-	if(menu_was_opened){
-		
-		// Reset the start time and counter
-		menu_was_opened = false;
-		timer_start_time = persist_exists(TIMER_START_TIME) ? persist_read_int(TIMER_START_TIME) : DEFAULT_TIMER_START_TIME;
-		s_time = timer_start_time;
-	}
 }
 
 /*
@@ -182,31 +329,39 @@ static void initTextLayer(){
 	
 	// Initiate window layer
   Layer *window_layer = window_get_root_layer(window);
-  GRect window_bounds = layer_get_bounds(window_layer);
 	
-	// Create minute text layer and add it to the window layer
-  minute_text_layer = text_layer_create((GRect) { .origin = { -10, 10 }, .size = { window_bounds.size.w - 30, window_bounds.size.h/2 } });
-  text_layer_set_text_alignment(minute_text_layer, GTextAlignmentRight);
-	text_layer_set_font(minute_text_layer, fonts_get_system_font(FONT_KEY_BITHAM_42_BOLD));
-  layer_add_child(window_layer, text_layer_get_layer(minute_text_layer));
+	// The progress goes underneath the digits
+	progress_layer = progress_layer_create(LAYOUT_PROGRESS_FRAME);
+	progress_stale = true;
+  layer_add_child(window_layer, progress_layer_get_layer(progress_layer));
 	
-	// Create second text layer and add it to the window layer
-  second_text_layer = text_layer_create((GRect) { .origin = { -10, window_bounds.size.h/2 }, .size = { window_bounds.size.w - 30, window_bounds.size.h/2 } });
-  text_layer_set_text_alignment(second_text_layer, GTextAlignmentRight);
-	text_layer_set_font(second_text_layer, fonts_get_system_font(FONT_KEY_BITHAM_42_LIGHT));
-  layer_add_child(window_layer, text_layer_get_layer(second_text_layer));
+	// Create the digit layer, minutes over seconds, and add it to the window layer
+	digit_layer = digit_layer_create(LAYOUT_DIGIT_FRAME, LAYOUT_DIGIT_INSET);
+  layer_add_child(window_layer, digit_layer_get_layer(digit_layer));
+}
+
+// Load the icons, the buttons work before they show up
+static void icon_timer_callback(void *data){
+	icon_timer = NULL;
 	
+	my_icon_play = icon_cache_acquire(RESOURCE_ID_IMAGE_PLAY2);
+	my_icon_pause = icon_cache_acquire(RESOURCE_ID_IMAGE_PAUSE2);
+	my_icon_settings = icon_cache_acquire(RESOURCE_ID_IMAGE_SETTINGS2);
+	my_icon_restart = icon_cache_acquire(RESOURCE_ID_IMAGE_RESTART2);
+	icons_loaded = true;
 	
+  action_bar_layer_set_icon(action_bar, BUTTON_ID_SELECT, my_icon_settings);
+  action_bar_layer_set_icon(action_bar, BUTTON_ID_DOWN, my_icon_restart);
+	updatePlayIcon();
 }
+
 static void window_load(Window *window) {
+	PROFILE_BEGIN(PROFILE_WINDOW_LOAD);
 	
-	// Get persistant time variables
-	timer_start_time = persist_exists(TIMER_START_TIME) ? persist_read_int(TIMER_START_TIME) : DEFAULT_TIMER_START_TIME;
-	interval_time = persist_exists(INTERVAL_TIME) ? persist_read_int(INTERVAL_TIME) : DEFAULT_INTERVAL_TIME;
-	final_warning_time = persist_exists(FINAL_WARNING_TIME) ? persist_read_int(FINAL_WARNING_TIME) : DEFAULT_FINAL_WARNING_TIME;
-	
-	// Set s_time to start time
-	s_time = timer_start_time;
+	// The battery decides how long the seconds stay off
+	BatteryChargeState battery = battery_state_service_peek();
+	battery_low = battery.charge_percent <= LOW_BATTERY_PERCENT && !battery.is_charging;
+	battery_state_service_subscribe(battery_handler);
 	
 	// Initialize text layer
 	initTextLayer();
@@ -221,25 +376,61 @@ static void window_load(Window *window) {
   action_bar_layer_set_click_config_provider(action_bar,
                                              click_config_provider);
 
-	// Load the icons
-	my_icon_play = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_PLAY2);
-	my_icon_pause = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_PAUSE2);
-	my_icon_settings = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_SETTINGS2);
-	my_icon_restart = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_RESTART2);
+	// Decoding the icons waits until after the first frame
+	icon_timer = app_timer_register(DEFERRED_LOAD_MS, icon_timer_callback, NULL);
 	
-  // Set the icons:
-  // The loading of the icons is omitted for brevity... See gbitmap_create_with_resource()
-  action_bar_layer_set_icon(action_bar, BUTTON_ID_UP, my_icon_play);
-  action_bar_layer_set_icon(action_bar, BUTTON_ID_SELECT, my_icon_settings);
-  action_bar_layer_set_icon(action_bar, BUTTON_ID_DOWN, my_icon_restart);
+	PROFILE_END();
+}
+
+static void window_appear(Window *window)
+{
+	window_visible = true;
+	
+	// Write whatever was changed in the menu in one go
+	settings_flush();
 	
-	// Set the state to not be running
-	timer_running = (bool) false;
+	// Catch up on whatever happened while covered, then follow along.
+	// The times may have changed in the menu.
+	progress_stale = true;
+	timer_core_advance();
+	timer_core_subscribe(timer_event_handler);
+	timer_event_handler(TIMER_EVENT_STATE);
+}
+
+static void window_disappear(Window *window)
+{
+	window_visible = false;
+	timer_core_unsubscribe(timer_event_handler);
+	updateSchedule();
 }
 
 static void window_unload(Window *window)
 {
-	text_layer_destroy(text_layer);
+	PROFILE_BEGIN(PROFILE_WINDOW_UNLOAD);
+	
+	scheduler_deinit();
+	battery_state_service_unsubscribe();
+	updateTapService(false);
+	stopPeek();
+	digit_layer_destroy(digit_layer);
+	progress_layer_destroy(progress_layer);
+	action_bar_layer_destroy(action_bar);
+	
+	// Give the icons back to the cache, if they got loaded at all
+	if(icon_timer){
+		app_timer_cancel(icon_timer);
+		icon_timer = NULL;
+	}
+	
+	if(icons_loaded){
+		icon_cache_release(RESOURCE_ID_IMAGE_PLAY2);
+		icon_cache_release(RESOURCE_ID_IMAGE_PAUSE2);
+		icon_cache_release(RESOURCE_ID_IMAGE_SETTINGS2);
+		icon_cache_release(RESOURCE_ID_IMAGE_RESTART2);
+		icons_loaded = false;
+	}
+	
+	PROFILE_END();
 	window_destroy(window);
 	window_stack_pop_all(false);
 	// closeApp();
@@ -252,21 +443,19 @@ static void window_unload(Window *window)
 */
 void timer_window_init(void)
 {
+  // Ticks are only subscribed while running and visible
+  scheduler_init(timer_wake_handler);
+	
 	// Create window and add loading callback
   window = window_create();
   window_set_click_config_provider(window, click_config_provider);
   window_set_window_handlers(window, (WindowHandlers) {
 		.load = window_load,
+		.appear = window_appear,
+		.disappear = window_disappear,
     .unload = window_unload,
   });
 		
   window_stack_push(window, ANIMATED);
-		
-	
-	menu_was_opened = false;
 	 
-  // Subscribe to TickTimerService
-  tick_timer_service_subscribe(SECOND_UNIT, tick_handler);
 }
-
-	
\ No newline at end of file
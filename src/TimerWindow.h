@@ -8,9 +8,17 @@
 #ifndef TIMERWINDOW_H_
 #define TIMERWINDOW_H_
 	
+// How long a tap shows the seconds for
+#define PEEK_TIME_MS 10000
+
+// Seconds are left off the screen until this few are left, or the final
+// warning when the battery is low
+#define SECONDS_TIME 300
+
+// Battery level that counts as low, unless it is charging
+#define LOW_BATTERY_PERCENT 20
+
 void timer_window_init(void);
-void resetTimer(void);
-void stopTimer(void);
 void updateTextLayer(void);
 
 
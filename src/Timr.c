@@ -1,13 +1,40 @@
 #include <pebble.h>
 	
 #include "Timr.h"
+#include "Settings.h"
+#include "PowerStats.h"
+#include "SessionLog.h"
+#include "TimerCore.h"
+#include "Presenter.h"
+#include "Background.h"
+#include "VibePatterns.h"
 	
 #include "TimerWindow.h"
 #include "MenuWindow.h"
 #include "SetTimeWindow.h"
+#include "Profiler.h"
 	
 int8_t curWindow = 0;
 
+/*
+	Window Manager
+	========================================================================================
+*/
+// Windows are created the first time they are needed and kept until the app exits,
+// navigating only rebinds their data and pushes them
+static void pushWindow(Window *window)
+{
+	if(window && !window_stack_contains_window(window))
+		window_stack_push(window, ANIMATED);
+}
+
+static void deinitWindows()
+{
+	menu_window_deinit();
+	set_time_window_deinit();
+	debug_window_deinit();
+}
+
 void switchWindow(uint8_t newWindow)
 {
 	switch(newWindow)
@@ -18,29 +45,106 @@ void switchWindow(uint8_t newWindow)
 		break;
 	case MENU_WINDOW:
 		curWindow = MENU_WINDOW;
-		menu_window_init();
+		pushWindow(menu_window_get());
 		break;
 	case SET_TIMER_START_WINDOW:
 		curWindow = SET_TIME_WINDOW;
-		set_time_window_init(SET_TIMER_START_WINDOW);
+		pushWindow(set_time_window_get(SET_TIMER_START_WINDOW));
 		break;
 	case SET_TIMER_INTERVAL_WINDOW:
 		curWindow = SET_TIME_WINDOW;
-		set_time_window_init(SET_TIMER_INTERVAL_WINDOW);
+		pushWindow(set_time_window_get(SET_TIMER_INTERVAL_WINDOW));
 		break;
 	case SET_FINAL_WARNING_WINDOW:
 		curWindow = SET_TIME_WINDOW;
-		set_time_window_init(SET_FINAL_WARNING_WINDOW);
+		pushWindow(set_time_window_get(SET_FINAL_WARNING_WINDOW));
+		break;
+#ifdef TIMR_PROFILE
+	case DEBUG_WINDOW:
+		pushWindow(debug_window_get());
 		break;
+#endif
 	}
 }
 
+/*
+	Timer
+	========================================================================================
+*/
+// The core only keeps time, cues are played and logged by its subscribers.
+// A countdown left running in the background is picked up, with the cue it was opened for.
+static void timerInit()
+{
+	Countdown countdown;
+	uint8_t segment;
+	
+	timer_core_init();
+	vibe_patterns_init();
+	session_log_init();
+	
+	if(background_restore(&countdown, &segment))
+		timer_core_resume(&countdown, segment);
+	
+	if(background_cue_launch())
+		timer_core_replay_cues(CUE_LAUNCH_LATE);
+}
+
+// Hand a running countdown to the background
+static void timerDeinit()
+{
+	background_enter(timer_core_countdown(), timer_core_get(), timer_core_timeline());
+	session_log_deinit();
+	vibe_patterns_deinit();
+	timer_core_deinit();
+}
+
+// A cue launch closes once its pattern has played out
+static AppTimer *s_cue_launch_timer;
+
+static void cue_launch_timer_callback(void *data){
+	s_cue_launch_timer = NULL;
+	window_stack_pop_all(false);
+}
+
 int main(void) {
 	
+	power_stats_init();
+	
+	PROFILE_LAUNCH();
+	
+	// Load settings once, everything else reads the cache. Agendas load when one is first used.
+	settings_init();
+	
+	// Pick the countdown up before anything draws it
+	timerInit();
+	
 	switchWindow(0);
+	
+	// Opened only to play a cue. Closing straight away would cut the pattern short,
+	// so the timer shows until it has played and then hands the countdown back.
+	bool cue_launch = background_cue_launch();
+	if(cue_launch)
+		s_cue_launch_timer = app_timer_register(vibe_patterns_remaining_ms(), cue_launch_timer_callback, NULL);
+	else
+		presenter_init();
 
 	app_event_loop();
+	
+	// Closed some other way first, the back button say
+	if(s_cue_launch_timer)
+		app_timer_cancel(s_cue_launch_timer);
+	if(!cue_launch)
+		presenter_deinit();
+	timerDeinit();
+	
+	settings_flush();
+	session_log_flush();
+	
+	// Compare this session against the power budgets
+	power_stats_report();
+	profiler_dump();
 
 	window_stack_pop_all(false);
+	deinitWindows();
 	return 0;
 }
@@ -19,29 +19,79 @@
 #define SET_TIMER_START_WINDOW 3
 #define SET_TIMER_INTERVAL_WINDOW 4
 #define SET_FINAL_WARNING_WINDOW 5
+
+// Hidden profiler screen, only built with TIMR_PROFILE
+#define DEBUG_WINDOW 6
 	
 // Used in setting time windows
 #define MINUTES true
 #define SECONDS false
-#define DARK 0
-#define LIGHT 1
 	
 	
 // Timer settings
 // ================================
 	
+// Which setting settings_set() changes
+#define TIMER_START_TIME 0
+#define INTERVAL_TIME 1
+#define FINAL_WARNING_TIME 2
+#define AGENDA_SELECTED 3
+#define PRESET_SELECTED 4
+	
 // Timer
-#define TIMER_START_TIME 300
 #define DEFAULT_TIMER_START_TIME 300
 
 // Interval time
-#define INTERVAL_TIME 30
 #define DEFAULT_INTERVAL_TIME 30
 	
 // Final warning
-#define FINAL_WARNING_TIME 60
 #define DEFAULT_FINAL_WARNING_TIME 60
 	
+// Agendas
+#define DEFAULT_AGENDA_SELECTED 0
+	
+// Presets
+#define DEFAULT_PRESET_SELECTED 0
+	
+	
+// Persistent storage keys
+// ================================
+	
+// Every setting, stored as one versioned record
+#define SETTINGS_RECORD 1
+	
+// End time of a countdown left running while the app is closed
+#define BACKGROUND_END_TIME 1000
+	
+// Every agenda
+#define AGENDA_BOOK 1001
+	
+// Session log ring, the head then SESSION_LOG_BLOCKS keys from SESSION_LOG_BLOCK
+#define SESSION_LOG_HEAD 1003
+#define SESSION_LOG_BLOCK 1010
+	
+// Keys used before the settings record, only read to migrate them
+#define LEGACY_TIMER_START_TIME 300
+#define LEGACY_INTERVAL_TIME 30
+#define LEGACY_FINAL_WARNING_TIME 60
+#define LEGACY_AGENDA_SELECTED 1002
+	
+	
+// AppMessage keys, match appKeys in appinfo.json
+// ================================
+	
+// Session log export
+#define KEY_LOG_RECORDS 0
+#define KEY_LOG_OFFSET 1
+#define KEY_LOG_TOTAL 2
+
+// Presenter view, only sent when the timer changes
+#define KEY_PRESENTER_STATE 3
+#define KEY_PRESENTER_SEGMENT 4
+#define KEY_PRESENTER_TOTAL 5
+#define KEY_PRESENTER_ANCHOR 6
+#define KEY_PRESENTER_REMAINING 7
+	
 	
 void setCurWindow(uint8_t newWindow);
 void switchWindow(uint8_t newWindow);
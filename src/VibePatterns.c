@@ -0,0 +1,108 @@
+#include <pebble.h>
+
+#include "VibePatterns.h"
+#include "TimerCore.h"
+#include "Countdown.h"
+#include "PowerStats.h"
+
+/*
+	Pattern Tables
+	========================================================================================
+*/
+// On/off durations in ms, all built at compile time
+static const uint32_t s_interval_light[] = { 80 };
+static const uint32_t s_interval_strong[] = { 250 };
+static const uint32_t s_final_warning[] = { 200, 150, 200 };
+static const uint32_t s_last_ten[] = { 100, 100, 100, 100, 100 };
+static const uint32_t s_time_up[] = { 600, 200, 600, 200, 600 };
+static const uint32_t s_overtime[] = { 400, 150, 80, 150, 80 };
+
+#define PATTERN(segments) { .durations = segments, .num_segments = ARRAY_LENGTH(segments) }
+
+// Indexed by VibeId
+static const VibePattern s_patterns[NUM_VIBES] = {
+	PATTERN(s_interval_light),
+	PATTERN(s_interval_strong),
+	PATTERN(s_final_warning),
+	PATTERN(s_last_ten),
+	PATTERN(s_time_up),
+	PATTERN(s_overtime),
+};
+
+// When the last pattern played stops, watch clock
+static int64_t s_playing_until_ms;
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+// One call per cue, nothing is built or allocated here
+void vibe_patterns_play(VibeId vibe){
+	if(vibe >= NUM_VIBES)
+		return;
+	
+	vibes_enqueue_custom_pattern(s_patterns[vibe]);
+	STATS_COUNT(STAT_VIBE);
+	
+	uint32_t duration_ms = 0;
+	for(uint32_t i = 0; i < s_patterns[vibe].num_segments; i++)
+		duration_ms += s_patterns[vibe].durations[i];
+	s_playing_until_ms = countdown_now_ms() + duration_ms;
+}
+
+// Time left of the last pattern played, 0 once it has stopped
+uint32_t vibe_patterns_remaining_ms(){
+	int64_t remaining_ms = s_playing_until_ms - countdown_now_ms();
+	return remaining_ms > 0 ? remaining_ms : 0;
+}
+
+// Play the prebuilt pattern of a cue, interval cues get stronger near the end
+void vibe_patterns_play_cue(CueType type, int remaining){
+	switch(type){
+		case CUE_INTERVAL:
+			vibe_patterns_play(remaining < INTERVAL_STRONG_TIME ? VIBE_INTERVAL_STRONG : VIBE_INTERVAL_LIGHT);
+		break;
+		case CUE_FINAL_WARNING:
+			vibe_patterns_play(VIBE_FINAL_WARNING);
+		break;
+		case CUE_LAST_TEN:
+			vibe_patterns_play(VIBE_LAST_TEN);
+		break;
+		case CUE_TIME_UP:
+			vibe_patterns_play(VIBE_TIME_UP);
+		break;
+		case CUE_OVERTIME:
+			vibe_patterns_play(VIBE_OVERTIME);
+		break;
+		default:
+		break;
+	}
+}
+
+
+/*
+	Events
+	========================================================================================
+*/
+// The core says which cue was passed, it is played here
+static void timer_event_handler(TimerEventType event){
+	if(event != TIMER_EVENT_CUE)
+		return;
+	
+	const TimerState *state = timer_core_get();
+	vibe_patterns_play_cue(state->cue, state->overtime ? 0 : state->time);
+}
+
+
+/*
+	Init and Deinit
+	========================================================================================
+*/
+void vibe_patterns_init(){
+	timer_core_subscribe(timer_event_handler);
+}
+
+void vibe_patterns_deinit(){
+	timer_core_unsubscribe(timer_event_handler);
+}
@@ -0,0 +1,29 @@
+/*
+ * VibePatterns.h
+ */
+
+#ifndef VIBEPATTERNS_H_
+#define VIBEPATTERNS_H_
+
+#include <pebble.h>
+
+#include "Cues.h"
+
+// Every pattern the app plays, each one can be told apart without looking
+typedef enum {
+	VIBE_INTERVAL_LIGHT,
+	VIBE_INTERVAL_STRONG,
+	VIBE_FINAL_WARNING,
+	VIBE_LAST_TEN,
+	VIBE_TIME_UP,
+	VIBE_OVERTIME,
+	NUM_VIBES
+} VibeId;
+
+void vibe_patterns_init(void);
+void vibe_patterns_deinit(void);
+void vibe_patterns_play(VibeId vibe);
+void vibe_patterns_play_cue(CueType type, int remaining);
+uint32_t vibe_patterns_remaining_ms(void);
+
+#endif /* VIBEPATTERNS_H_ */
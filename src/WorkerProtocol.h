@@ -0,0 +1,25 @@
+/*
+ * WorkerProtocol.h
+ */
+
+#ifndef WORKERPROTOCOL_H_
+#define WORKERPROTOCOL_H_
+
+// Shared by the app and worker_src, so it only needs the standard types
+#include <stdint.h>
+
+// What is stored in BACKGROUND_END_TIME while the app is closed. The worker
+// builds the segment's cues from its times with Cues.c, like the app does.
+typedef struct __attribute__((__packed__)) {
+	int64_t end_ms;
+	uint8_t segment;
+	uint16_t timer_start_time;
+	uint16_t interval_time;
+	uint16_t final_warning_time;
+} BackgroundState;
+
+// AppWorkerMessage types
+// App to worker: reread the stored state, sent if the worker was still running
+#define WORKER_RELOAD 0
+
+#endif /* WORKERPROTOCOL_H_ */
@@ -0,0 +1,99 @@
+/*
+ * Presenter view
+ *
+ * Mirrors the countdown on the phone as a confidence monitor. The watch only
+ * sends a message when the timer starts, pauses, resets or moves to the next
+ * segment (see Presenter.c), so the time left is worked out here from when the
+ * time is up. Messages only carry what changed, the rest is kept from before.
+ */
+var Presenter = (function () {
+  var STATES = ['stopped', 'running', 'paused'];
+
+  // Further apart than this and the watch and phone clocks can't be trusted
+  // to agree, so the time a message arrived is used instead of its anchor
+  var MAX_SKEW = 2000;
+
+  var timer = { state: 'stopped', segment: 0, total: 0, endAt: 0, remaining: 0 };
+
+  // now is only passed in to stand in for the clock
+  function receive(payload, now) {
+    now = now === undefined ? Date.now() : now;
+
+    timer.state = STATES[payload.PRESENTER_STATE] || 'stopped';
+    if (payload.PRESENTER_SEGMENT !== undefined) {
+      timer.segment = payload.PRESENTER_SEGMENT;
+    }
+    if (payload.PRESENTER_TOTAL !== undefined) {
+      timer.total = payload.PRESENTER_TOTAL;
+    }
+
+    // Running, the remaining time is measured from the anchor. Otherwise it stays put.
+    if (timer.state === 'running') {
+      var anchor = payload.PRESENTER_ANCHOR * 1000;
+      timer.endAt = (Math.abs(now - anchor) < MAX_SKEW ? anchor : now) + payload.PRESENTER_REMAINING;
+    } else {
+      timer.remaining = payload.PRESENTER_REMAINING;
+    }
+
+    localStorage.setItem('presenter', JSON.stringify(timer));
+    console.log('Presenter: ' + timer.state + ', segment ' + timer.segment + ', ' + format(remaining(now)));
+  }
+
+  // Milliseconds left of a stored timer, negative past zero. The page runs the same.
+  function project(t, now) {
+    return t.state === 'running' ? t.endAt - now : t.remaining;
+  }
+
+  function remaining(now) {
+    return project(timer, now === undefined ? Date.now() : now);
+  }
+
+  // Same as the watch: whole seconds left rounded up, past zero counts up from 0:00
+  function format(ms) {
+    var overtime = ms < 0;
+    var seconds = overtime ? Math.floor(-ms / 1000) : Math.ceil(ms / 1000);
+    var text = Math.floor(seconds / 60) + ':' + ('0' + seconds % 60).slice(-2);
+    return overtime ? '+' + text : text;
+  }
+
+  // A page that keeps counting by itself. It starts from what is known when it
+  // opens and picks up every message stored after that.
+  function page() {
+    var snapshot = JSON.stringify(timer);
+    return 'data:text/html,' + encodeURIComponent(
+      '<html><body style="margin:0;background:#000;color:#fff;font:bold 30vw sans-serif;' +
+      'display:flex;align-items:center;justify-content:center;height:100vh">' +
+      '<div id="t"></div><script>' +
+      'var s=' + snapshot + ',f=' + format.toString() + ',p=' + project.toString() + ';' +
+      'function d(){try{var j=localStorage.getItem("presenter");if(j)s=JSON.parse(j);}catch(x){}' +
+      'var m=p(s,Date.now()),e=document.getElementById("t");' +
+      'e.textContent=f(m);e.style.color=m<0?"#f44":"#fff";}' +
+      'd();setInterval(d,250);' +
+      '</script></body></html>');
+  }
+
+  return {
+    receive: receive,
+    remaining: remaining,
+    format: format,
+    page: page
+  };
+})();
+
+// Only on the phone, the tests load this with node
+if (typeof Pebble !== 'undefined') {
+  Pebble.addEventListener('appmessage', function (e) {
+    if (e.payload.PRESENTER_STATE !== undefined) {
+      Presenter.receive(e.payload);
+    }
+  });
+
+  // Opened from the app's settings in the Pebble app
+  Pebble.addEventListener('showConfiguration', function () {
+    Pebble.openURL(Presenter.page());
+  });
+}
+
+if (typeof module !== 'undefined') {
+  module.exports = Presenter;
+}
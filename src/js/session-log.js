@@ -0,0 +1,107 @@
+/*
+ * Session log
+ *
+ * The watch sends its session log in batches of 8 byte records (see
+ * SessionLog.h). The batches are put back together here, split into talks
+ * and kept in localStorage so they can be looked at after the fact.
+ */
+var SessionLog = (function () {
+  var RECORD_SIZE = 8;
+  var EVENTS = ['start', 'pause', 'resume', 'restart', 'cue', 'segment', 'time up', 'stop'];
+  var CUES = ['none', 'interval', 'final warning', 'last ten', 'time up', 'overtime'];
+
+  var received = [];
+
+  // Records are little endian: uint32 time, uint16 value, uint8 event, uint8 detail
+  function decode(bytes) {
+    var records = [];
+    for (var i = 0; i + RECORD_SIZE <= bytes.length; i += RECORD_SIZE) {
+      var event = EVENTS[bytes[i + 6]] || 'unknown';
+      records.push({
+        time: (bytes[i] | bytes[i + 1] << 8 | bytes[i + 2] << 16 | bytes[i + 3] << 24) >>> 0,
+        value: bytes[i + 4] | bytes[i + 5] << 8,
+        event: event,
+        cue: event === 'cue' ? CUES[bytes[i + 7]] : undefined,
+        segment: event === 'cue' ? undefined : bytes[i + 7]
+      });
+    }
+    return records;
+  }
+
+  // One entry per talk, from a start to its stop (or the next start)
+  function sessions(records) {
+    var result = [];
+    var current = null;
+    var pausedAt = 0;
+
+    records.forEach(function (record) {
+      if (record.event === 'start') {
+        current = { start: record.time, end: record.time, paused: 0, pauses: 0, timeUp: false, overrun: 0, cues: [] };
+        result.push(current);
+      }
+      if (!current) {
+        return;
+      }
+
+      current.end = record.time;
+      if (record.event === 'pause') {
+        current.pauses++;
+        pausedAt = record.time;
+      } else if (record.event === 'resume' && pausedAt) {
+        current.paused += record.time - pausedAt;
+        pausedAt = 0;
+      } else if (record.event === 'cue') {
+        current.cues.push(record.cue);
+      } else if (record.event === 'time up') {
+        current.timeUp = true;
+      } else if (record.event === 'stop') {
+        // Past zero the value counts up instead of down
+        current.overrun = current.timeUp ? record.value : 0;
+        current = null;
+      }
+    });
+
+    return result;
+  }
+
+  function report(records) {
+    sessions(records).forEach(function (session) {
+      console.log('Session ' + new Date(session.start * 1000).toLocaleString() +
+        ': ' + (session.end - session.start) + 's, ' +
+        session.pauses + ' pauses (' + session.paused + 's), ' +
+        'overrun ' + session.overrun + 's, cues: ' + session.cues.join(', '));
+    });
+  }
+
+  // Batches arrive in order, the first one starts the log over
+  function receive(payload) {
+    if (payload.LOG_OFFSET === 0) {
+      received = [];
+    }
+    received = received.concat(decode(payload.LOG_RECORDS || []));
+
+    if (received.length >= payload.LOG_TOTAL) {
+      localStorage.setItem('sessionLog', JSON.stringify(received));
+      report(received);
+    }
+  }
+
+  return {
+    decode: decode,
+    sessions: sessions,
+    receive: receive
+  };
+})();
+
+// Only on the phone, the tests load this with node
+if (typeof Pebble !== 'undefined') {
+  Pebble.addEventListener('appmessage', function (e) {
+    if (e.payload.LOG_TOTAL !== undefined) {
+      SessionLog.receive(e.payload);
+    }
+  });
+}
+
+if (typeof module !== 'undefined') {
+  module.exports = SessionLog;
+}
@@ -0,0 +1,124 @@
+/*
+ * bench_power.c
+ *
+ * Replays whole talks through the app on the host, the way they'd go on the
+ * watch: set the time in the menu, start, pause once, run into overtime and
+ * acknowledge it. Every count the fakes made is checked against the budgets
+ * in PowerStats.h, anything over fails the run.
+ */
+
+#include <pebble.h>
+
+#include "check.h"
+#include "Timr.h"
+#include "PowerStats.h"
+
+// Timr.c is built with its main renamed
+int timr_main(void);
+
+#define SECOND 1000
+#define MINUTE (60 * SECOND)
+
+// Length of the talk being replayed, in minutes
+static int s_talk_minutes;
+
+
+/*
+	Replay
+	========================================================================================
+*/
+// Let time pass a second at a time, drawing whatever changed like the watch would
+static void play(int64_t ms){
+	for(int64_t played = 0; played < ms; played += SECOND){
+		fake_advance_ms(ms - played < SECOND ? ms - played : SECOND);
+		fake_render();
+	}
+}
+
+static void press(ButtonId button){
+	fake_press(button);
+	fake_render();
+}
+
+// Set Time starts at the default 5:00. Held, the first five repeats step a
+// minute and the next ten five minutes, topping out at 59:59.
+static void setTalkLength(){
+	uint8_t repeats = s_talk_minutes <= 10 ? s_talk_minutes - 5 : 5 + (s_talk_minutes - 10) / 5;
+
+	press(BUTTON_ID_SELECT);
+	fake_menu_click(0, 0);
+	fake_render();
+	if(repeats > 0)
+		fake_hold(BUTTON_ID_UP, repeats);
+	press(BUTTON_ID_BACK);
+	press(BUTTON_ID_BACK);
+}
+
+static void talk(){
+	fake_render();
+	play(2 * SECOND);
+	setTalkLength();
+	play(3 * SECOND);
+
+	// Half way through, a question holds things up
+	int64_t length_ms = (int64_t) s_talk_minutes * MINUTE;
+	press(BUTTON_ID_UP);
+	play(length_ms / 2);
+	press(BUTTON_ID_UP);
+	play(30 * SECOND);
+	press(BUTTON_ID_UP);
+
+	// Run over by a minute, then acknowledge it
+	play(length_ms - length_ms / 2 + MINUTE);
+	press(BUTTON_ID_UP);
+	play(5 * SECOND);
+}
+
+
+/*
+	Budgets
+	========================================================================================
+*/
+static bool checkStat(const char *name, uint32_t count, uint32_t budget){
+	bool over = count > budget;
+	printf("  %-16s %6u / %u%s\n", name, count, budget, over ? "  OVER BUDGET" : "");
+	return !over;
+}
+
+// Replay a talk of minutes, returns false if anything went over
+static bool bench(int minutes){
+	s_talk_minutes = minutes;
+	fake_reset(true);
+	fake_run(timr_main, talk);
+
+	// Rounded up like power_stats_report() does
+	uint32_t open = (fake_now_ms() - (int64_t) FAKE_EPOCH * 1000 + MINUTE - 1) / MINUTE;
+	printf("%d minute talk, open %u minutes\n", minutes, open);
+
+	bool within = true;
+	within &= checkStat("wakeups", fake_counts.wakeups, power_stats_budget(STAT_WAKEUP, open));
+	within &= checkStat("persist reads", fake_counts.persist_reads, power_stats_budget(STAT_PERSIST_READ, open));
+	within &= checkStat("persist writes", fake_counts.persist_writes, power_stats_budget(STAT_PERSIST_WRITE, open));
+	within &= checkStat("layer dirties", fake_counts.layer_dirties, power_stats_budget(STAT_LAYER_DIRTY, open));
+	within &= checkStat("vibes", fake_counts.vibes, power_stats_budget(STAT_VIBE, open));
+	within &= checkStat("messages sent", fake_counts.messages, power_stats_budget(STAT_MESSAGE, open));
+	within &= checkStat("heap high water", fake_counts.heap_high_water, BUDGET_HEAP_BYTES);
+
+	// Anything checked inside the replay, or a crash
+	return within && fake_check_failures == 0;
+}
+
+
+int main(void){
+	bool within = true;
+
+	within &= bench(5);
+	within &= bench(30);
+	within &= bench(60);
+
+	if(!within){
+		printf("over budget\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * check.h
+ *
+ * Just enough of a test runner for the host tests: checks report where they
+ * failed and carry on, the run fails if any of them did.
+ */
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fake_pebble.h"
+
+#define CHECK(cond) do { \
+	if(!(cond)){ \
+		fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		fake_check_failures++; \
+	} \
+} while(0)
+
+#define CHECK_EQ(actual, expected) do { \
+	long long actual_ = (long long) (actual), expected_ = (long long) (expected); \
+	if(actual_ != expected_){ \
+		fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actual_, expected_); \
+		fake_check_failures++; \
+	} \
+} while(0)
+
+#define CHECK_STR(actual, expected) do { \
+	const char *actual_ = (actual), *expected_ = (expected); \
+	if(actual_ == NULL || strcmp(actual_, expected_) != 0){ \
+		fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, actual_ ? actual_ : "(null)", expected_); \
+		fake_check_failures++; \
+	} \
+} while(0)
+
+#define RUN(test) do { \
+	uint32_t failures_ = fake_check_failures; \
+	fake_reset(true); \
+	test(); \
+	printf("%s %s\n", fake_check_failures == failures_ ? "pass" : "FAIL", #test); \
+} while(0)
+
+#endif /* CHECK_H_ */
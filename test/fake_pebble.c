@@ -0,0 +1,1362 @@
+#include <pebble.h>
+#include <pebble_worker.h>
+#include <math.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "fake_pebble.h"
+
+/*
+	Definitions
+	========================================================================================
+*/
+#define MAX_WINDOWS 8
+#define MAX_PERSIST_KEYS 64
+#define MAX_MENU_SECTIONS 4
+#define MAX_MENU_ROWS 8
+#define SCREEN_BOUNDS GRect(0, 0, 144, 168)
+
+// Icons are 18x18, one bit per pixel padded to whole words like aplite
+#define ICON_SIZE 18
+#define ICON_BYTES_PER_ROW 4
+
+// Wakeups can't be closer together than this
+#define WAKEUP_SPACING 60
+
+// Every allocation the app asks for carries its size, so the heap can be counted
+typedef struct {
+	size_t size;
+	uint64_t align[];
+} Allocation;
+
+struct Layer {
+	GRect frame;
+	LayerUpdateProc update_proc;
+	Layer *parent;
+	Layer *children;
+	Layer *next_sibling;
+	bool dirty;
+	uint64_t data[];
+};
+
+struct Window {
+	Layer *root;
+	WindowHandlers handlers;
+	ClickConfigProvider click_config_provider;
+	void *click_context;
+	ClickHandler single[NUM_BUTTONS];
+	ClickHandler repeating[NUM_BUTTONS];
+	MenuLayer *menu;
+	bool loaded;
+};
+
+struct TextLayer {
+	Layer *layer;
+	const char *text;
+};
+
+struct ActionBarLayer {
+	Layer *layer;
+	Window *window;
+	const GBitmap *icons[NUM_BUTTONS];
+};
+
+struct MenuLayer {
+	Layer *layer;
+	MenuLayerCallbacks callbacks;
+	void *context;
+	MenuIndex selected;
+};
+
+struct GBitmap {
+	uint32_t resource_id;
+};
+
+struct AppTimer {
+	int64_t due_ms;
+	uint32_t order;
+	AppTimerCallback callback;
+	void *data;
+	AppTimer *next;
+};
+
+struct DictionaryIterator {
+	FakeMessage *message;
+};
+
+// What a repeating click handler is told about the press
+typedef struct {
+	uint8_t count;
+} FakeRecognizer;
+
+typedef struct {
+	uint32_t key;
+	size_t size;
+	uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistEntry;
+
+
+/*
+	Variables
+	========================================================================================
+*/
+FakeCounts fake_counts;
+FakeVibe fake_vibes[FAKE_MAX_VIBES];
+FakeMessage fake_messages[FAKE_MAX_MESSAGES];
+FakeWakeup fake_wakeups[FAKE_MAX_WAKEUPS];
+uint8_t fake_num_wakeups;
+int64_t fake_app_launches[FAKE_MAX_APP_LAUNCHES];
+uint32_t fake_check_failures;
+
+static int64_t s_now_ms;
+static size_t s_heap;
+static void (*s_scenario)(void);
+
+// Window stack, bottom first
+static Window *s_stack[MAX_WINDOWS];
+static uint8_t s_stack_size;
+static Window *s_configuring;
+
+// Ticks and timers
+static TickHandler s_tick_handler;
+static TimeUnits s_tick_unit;
+static AppTimer *s_timers;
+static uint32_t s_timer_order;
+
+// Storage outlives fake_reset() unless it is wiped
+static PersistEntry s_persist[MAX_PERSIST_KEYS];
+static uint8_t s_num_persist;
+static bool s_storage_full;
+
+// System, battery, worker and phone
+static AppLaunchReason s_launch_reason;
+static int32_t s_wakeup_cookie;
+static bool s_wakeups_available;
+static BatteryChargeState s_battery;
+static BatteryStateHandler s_battery_handler;
+static AccelTapHandler s_tap_handler;
+static AppWorkerResult s_worker_result;
+static bool s_worker_running;
+static AppWorkerMessageHandler s_worker_handler;
+
+static bool s_connected;
+static bool s_message_open;
+static int64_t s_outbox_due_ms;
+static DictionaryIterator s_outbox;
+static AppMessageOutboxSent s_sent_callback;
+static AppMessageOutboxFailed s_failed_callback;
+
+// Titles from the last menu render
+static const char *s_menu_titles[MAX_MENU_SECTIONS][MAX_MENU_ROWS];
+static const char *s_menu_subtitles[MAX_MENU_SECTIONS][MAX_MENU_ROWS];
+static MenuIndex s_drawing_row;
+
+
+/*
+	Heap
+	========================================================================================
+*/
+static void* fakeAlloc(size_t size){
+	Allocation *allocation = calloc(1, sizeof(Allocation) + size);
+	allocation->size = size;
+
+	s_heap += size;
+	if(s_heap > fake_counts.heap_high_water)
+		fake_counts.heap_high_water = s_heap;
+
+	return allocation->align;
+}
+
+static void fakeFree(void *pointer){
+	if(pointer == NULL)
+		return;
+
+	Allocation *allocation = (Allocation *) ((char *) pointer - offsetof(Allocation, align));
+	s_heap -= allocation->size;
+	free(allocation);
+}
+
+size_t heap_bytes_used(){
+	return s_heap;
+}
+
+size_t fake_heap_bytes(){
+	return s_heap;
+}
+
+
+/*
+	Control
+	========================================================================================
+*/
+void fake_reset(bool wipe_storage){
+	memset(&fake_counts, 0, sizeof(fake_counts));
+	memset(fake_vibes, 0, sizeof(fake_vibes));
+	memset(fake_messages, 0, sizeof(fake_messages));
+	fake_num_wakeups = 0;
+	memset(fake_app_launches, 0, sizeof(fake_app_launches));
+
+	while(s_timers){
+		AppTimer *next = s_timers->next;
+		fakeFree(s_timers);
+		s_timers = next;
+	}
+
+	s_now_ms = (int64_t) FAKE_EPOCH * 1000;
+	s_heap = 0;
+	s_stack_size = 0;
+	s_tick_handler = NULL;
+	s_tick_unit = 0;
+	s_launch_reason = APP_LAUNCH_USER;
+	s_wakeups_available = true;
+	s_battery = (BatteryChargeState) { .charge_percent = 80 };
+	s_battery_handler = NULL;
+	s_tap_handler = NULL;
+	s_worker_result = APP_WORKER_RESULT_SUCCESS;
+	s_worker_running = false;
+	s_worker_handler = NULL;
+	s_connected = true;
+	s_message_open = false;
+	s_outbox_due_ms = -1;
+	s_sent_callback = NULL;
+	s_failed_callback = NULL;
+
+	s_storage_full = false;
+
+	if(wipe_storage)
+		s_num_persist = 0;
+}
+
+// Everything a launch leaves behind for the test and the next launch
+typedef struct {
+	FakeCounts counts;
+	FakeVibe vibes[FAKE_MAX_VIBES];
+	FakeMessage messages[FAKE_MAX_MESSAGES];
+	FakeWakeup wakeups[FAKE_MAX_WAKEUPS];
+	uint8_t num_wakeups;
+	int64_t app_launches[FAKE_MAX_APP_LAUNCHES];
+	uint32_t check_failures;
+	int64_t now_ms;
+	size_t heap;
+	PersistEntry persist[MAX_PERSIST_KEYS];
+	uint8_t num_persist;
+	bool worker_running;
+} FakeOutcome;
+
+static void saveOutcome(FakeOutcome *outcome){
+	outcome->counts = fake_counts;
+	memcpy(outcome->vibes, fake_vibes, sizeof(fake_vibes));
+	memcpy(outcome->messages, fake_messages, sizeof(fake_messages));
+	memcpy(outcome->wakeups, fake_wakeups, sizeof(fake_wakeups));
+	outcome->num_wakeups = fake_num_wakeups;
+	memcpy(outcome->app_launches, fake_app_launches, sizeof(fake_app_launches));
+	outcome->check_failures = fake_check_failures;
+	outcome->now_ms = s_now_ms;
+	outcome->heap = s_heap;
+	memcpy(outcome->persist, s_persist, sizeof(s_persist));
+	outcome->num_persist = s_num_persist;
+	outcome->worker_running = s_worker_running;
+}
+
+static void loadOutcome(const FakeOutcome *outcome){
+	fake_counts = outcome->counts;
+	memcpy(fake_vibes, outcome->vibes, sizeof(fake_vibes));
+	memcpy(fake_messages, outcome->messages, sizeof(fake_messages));
+	memcpy(fake_wakeups, outcome->wakeups, sizeof(fake_wakeups));
+	fake_num_wakeups = outcome->num_wakeups;
+	memcpy(fake_app_launches, outcome->app_launches, sizeof(fake_app_launches));
+	fake_check_failures = outcome->check_failures;
+	s_now_ms = outcome->now_ms;
+	s_heap = outcome->heap;
+	memcpy(s_persist, outcome->persist, sizeof(s_persist));
+	s_num_persist = outcome->num_persist;
+	s_worker_running = outcome->worker_running;
+}
+
+// Each launch runs in its own process so the app starts with fresh statics,
+// like it does on the watch. What it leaves behind is copied back.
+void fake_run(int (*app_main)(void), void (*scenario)(void)){
+	FakeOutcome *outcome = mmap(NULL, sizeof(FakeOutcome), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	fflush(stdout);
+	fflush(stderr);
+
+	pid_t child = fork();
+	if(child == 0){
+		s_scenario = scenario;
+		app_main();
+		saveOutcome(outcome);
+		_exit(0);
+	}
+
+	int status;
+	waitpid(child, &status, 0);
+	if(WIFEXITED(status) && WEXITSTATUS(status) == 0){
+		loadOutcome(outcome);
+	}else{
+		fprintf(stderr, "app crashed (status %d)\n", status);
+		fake_check_failures++;
+	}
+
+	munmap(outcome, sizeof(FakeOutcome));
+}
+
+// The scenario stands in for the user, the loop ends when it returns
+void app_event_loop(){
+	if(s_scenario)
+		s_scenario();
+}
+
+void fake_set_launch(AppLaunchReason reason, int32_t wakeup_cookie){
+	s_launch_reason = reason;
+	s_wakeup_cookie = wakeup_cookie;
+}
+
+void fake_set_battery(uint8_t percent, bool charging){
+	s_battery.charge_percent = percent;
+	s_battery.is_charging = charging;
+	if(s_battery_handler)
+		s_battery_handler(s_battery);
+}
+
+void fake_set_worker(AppWorkerResult launch_result){
+	s_worker_result = launch_result;
+}
+
+// Unavailable, as if other apps held every wakeup slot
+void fake_set_wakeups_available(bool available){
+	s_wakeups_available = available;
+}
+
+void fake_set_connected(bool connected){
+	s_connected = connected;
+}
+
+// Full, every write fails and nothing is stored
+void fake_set_storage_full(bool full){
+	s_storage_full = full;
+}
+
+int64_t fake_now_ms(){
+	return s_now_ms;
+}
+
+AppLaunchReason launch_reason(){
+	return s_launch_reason;
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...){
+	if(getenv("FAKE_LOG") == NULL && log_level > APP_LOG_LEVEL_WARNING)
+		return;
+
+	va_list args;
+	va_start(args, fmt);
+	fprintf(stderr, "[%s:%d] ", src_filename, src_line_number);
+	vfprintf(stderr, fmt, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+}
+
+
+/*
+	Time
+	========================================================================================
+*/
+time_t fake_time(time_t *tloc){
+	time_t now = (time_t) (s_now_ms / 1000);
+	if(tloc)
+		*tloc = now;
+	return now;
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms){
+	uint16_t ms = s_now_ms % 1000;
+	fake_time(tloc);
+	if(out_ms)
+		*out_ms = ms;
+	return ms;
+}
+
+static int64_t unitMs(TimeUnits unit){
+	if(unit & SECOND_UNIT)
+		return 1000;
+	if(unit & MINUTE_UNIT)
+		return 60000;
+	return 3600000;
+}
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler){
+	fake_counts.tick_subscribes++;
+	s_tick_unit = tick_units;
+	s_tick_handler = handler;
+}
+
+void tick_timer_service_unsubscribe(){
+	s_tick_unit = 0;
+	s_tick_handler = NULL;
+}
+
+bool fake_ticks_subscribed(TimeUnits *unit){
+	if(unit)
+		*unit = s_tick_unit;
+	return s_tick_handler != NULL;
+}
+
+// Timers are kept in the order they are due, ties in the order they were set
+static void insertTimer(AppTimer *timer){
+	AppTimer **link = &s_timers;
+	while(*link && ((*link)->due_ms < timer->due_ms || ((*link)->due_ms == timer->due_ms && (*link)->order < timer->order)))
+		link = &(*link)->next;
+
+	timer->next = *link;
+	*link = timer;
+}
+
+// Take a timer out of the list, false if it isn't in it (it fired or was cancelled)
+static bool removeTimer(AppTimer *timer){
+	for(AppTimer **link = &s_timers; *link; link = &(*link)->next){
+		if(*link == timer){
+			*link = timer->next;
+			return true;
+		}
+	}
+	return false;
+}
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data){
+	AppTimer *timer = fakeAlloc(sizeof(AppTimer));
+	timer->due_ms = s_now_ms + timeout_ms;
+	timer->order = s_timer_order++;
+	timer->callback = callback;
+	timer->data = callback_data;
+	insertTimer(timer);
+
+	fake_counts.timers_registered++;
+	return timer;
+}
+
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms){
+	if(!removeTimer(timer))
+		return false;
+
+	timer->due_ms = s_now_ms + new_timeout_ms;
+	timer->order = s_timer_order++;
+	insertTimer(timer);
+	return true;
+}
+
+void app_timer_cancel(AppTimer *timer){
+	if(removeTimer(timer))
+		fakeFree(timer);
+}
+
+uint32_t fake_timers_pending(){
+	uint32_t count = 0;
+	for(AppTimer *timer = s_timers; timer; timer = timer->next)
+		count++;
+	return count;
+}
+
+static void ackOutbox(void);
+
+// Run everything due up to the new time: timers, then ticks, then the phone
+void fake_advance_ms(int64_t ms){
+	int64_t end_ms = s_now_ms + ms;
+
+	for(;;){
+		int64_t tick_ms = s_tick_handler ? (s_now_ms / unitMs(s_tick_unit) + 1) * unitMs(s_tick_unit) : INT64_MAX;
+		int64_t timer_ms = s_timers ? s_timers->due_ms : INT64_MAX;
+		int64_t outbox_ms = s_outbox_due_ms >= 0 ? s_outbox_due_ms : INT64_MAX;
+
+		int64_t next_ms = timer_ms < tick_ms ? timer_ms : tick_ms;
+		if(outbox_ms < next_ms)
+			next_ms = outbox_ms;
+
+		if(next_ms > end_ms)
+			break;
+
+		if(next_ms > s_now_ms)
+			s_now_ms = next_ms;
+
+		if(timer_ms == next_ms){
+			AppTimer *timer = s_timers;
+			s_timers = timer->next;
+			AppTimerCallback callback = timer->callback;
+			void *data = timer->data;
+			fakeFree(timer);
+
+			fake_counts.wakeups++;
+			fake_counts.timer_fires++;
+			callback(data);
+		}else if(tick_ms == next_ms){
+			time_t now = (time_t) (s_now_ms / 1000);
+			struct tm tick_time = *gmtime(&now);
+
+			TimeUnits changed = SECOND_UNIT;
+			if(tick_time.tm_sec == 0)
+				changed |= MINUTE_UNIT;
+			if(tick_time.tm_sec == 0 && tick_time.tm_min == 0)
+				changed |= HOUR_UNIT;
+
+			fake_counts.wakeups++;
+			fake_counts.ticks++;
+			s_tick_handler(&tick_time, changed);
+		}else{
+			ackOutbox();
+		}
+	}
+
+	s_now_ms = end_ms;
+}
+
+WakeupId wakeup_schedule(time_t timestamp, int32_t cookie, bool notify_if_missed){
+	if(!s_wakeups_available || timestamp <= fake_time(NULL) || fake_num_wakeups >= FAKE_MAX_WAKEUPS)
+		return -8;
+
+	for(int i = 0; i < fake_num_wakeups; i++){
+		if(labs((long) (fake_wakeups[i].time - timestamp)) < WAKEUP_SPACING)
+			return -8;
+	}
+
+	fake_wakeups[fake_num_wakeups++] = (FakeWakeup) { .time = timestamp, .cookie = cookie };
+	fake_counts.wakeups_scheduled++;
+	return fake_num_wakeups;
+}
+
+void wakeup_cancel_all(){
+	fake_num_wakeups = 0;
+}
+
+bool wakeup_get_launch_event(WakeupId *wakeup_id, int32_t *cookie){
+	if(s_launch_reason != APP_LAUNCH_WAKEUP)
+		return false;
+
+	*wakeup_id = 1;
+	*cookie = s_wakeup_cookie;
+	return true;
+}
+
+
+/*
+	Storage
+	========================================================================================
+*/
+static PersistEntry* findEntry(uint32_t key){
+	for(int i = 0; i < s_num_persist; i++){
+		if(s_persist[i].key == key)
+			return &s_persist[i];
+	}
+	return NULL;
+}
+
+bool fake_persist_get(uint32_t key, void *buffer, size_t size){
+	PersistEntry *entry = findEntry(key);
+	if(entry == NULL)
+		return false;
+
+	memcpy(buffer, entry->data, entry->size < size ? entry->size : size);
+	return true;
+}
+
+void fake_persist_set(uint32_t key, const void *data, size_t size){
+	PersistEntry *entry = findEntry(key);
+	if(entry == NULL)
+		entry = &s_persist[s_num_persist++];
+
+	entry->key = key;
+	entry->size = size > PERSIST_DATA_MAX_LENGTH ? PERSIST_DATA_MAX_LENGTH : size;
+	memcpy(entry->data, data, entry->size);
+}
+
+bool persist_exists(uint32_t key){
+	fake_counts.persist_reads++;
+	return findEntry(key) != NULL;
+}
+
+int persist_delete(uint32_t key){
+	fake_counts.persist_writes++;
+
+	PersistEntry *entry = findEntry(key);
+	if(entry == NULL)
+		return E_DOES_NOT_EXIST;
+
+	*entry = s_persist[--s_num_persist];
+	return 0;
+}
+
+int persist_read_data(uint32_t key, void *buffer, size_t buffer_size){
+	fake_counts.persist_reads++;
+
+	PersistEntry *entry = findEntry(key);
+	if(entry == NULL)
+		return E_DOES_NOT_EXIST;
+
+	size_t size = entry->size < buffer_size ? entry->size : buffer_size;
+	memcpy(buffer, entry->data, size);
+	return size;
+}
+
+int32_t persist_read_int(uint32_t key){
+	int32_t value = 0;
+	persist_read_data(key, &value, sizeof(value));
+	return value;
+}
+
+int persist_write_data(uint32_t key, const void *data, size_t size){
+	fake_counts.persist_writes++;
+	if(s_storage_full)
+		return E_OUT_OF_STORAGE;
+
+	fake_persist_set(key, data, size);
+	return size > PERSIST_DATA_MAX_LENGTH ? PERSIST_DATA_MAX_LENGTH : size;
+}
+
+int persist_write_int(uint32_t key, int32_t value){
+	return persist_write_data(key, &value, sizeof(value));
+}
+
+
+/*
+	Vibes, Battery and Taps
+	========================================================================================
+*/
+void vibes_enqueue_custom_pattern(VibePattern pattern){
+	if(fake_counts.vibes < FAKE_MAX_VIBES){
+		FakeVibe *vibe = &fake_vibes[fake_counts.vibes];
+		vibe->time_ms = s_now_ms;
+		vibe->num_segments = pattern.num_segments;
+		for(uint32_t i = 0; i < pattern.num_segments && i < ARRAY_LENGTH(vibe->durations); i++)
+			vibe->durations[i] = pattern.durations[i];
+	}
+	fake_counts.vibes++;
+}
+
+// The system pulses, recorded like a custom pattern of the same length
+static void pulse(const uint32_t *durations, uint32_t num_segments){
+	vibes_enqueue_custom_pattern((VibePattern) { .durations = durations, .num_segments = num_segments });
+}
+
+void vibes_short_pulse(){
+	static const uint32_t durations[] = { 100 };
+	pulse(durations, ARRAY_LENGTH(durations));
+}
+
+void vibes_long_pulse(){
+	static const uint32_t durations[] = { 500 };
+	pulse(durations, ARRAY_LENGTH(durations));
+}
+
+void vibes_double_pulse(){
+	static const uint32_t durations[] = { 100, 100, 100 };
+	pulse(durations, ARRAY_LENGTH(durations));
+}
+
+BatteryChargeState battery_state_service_peek(){
+	return s_battery;
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler){
+	s_battery_handler = handler;
+}
+
+void battery_state_service_unsubscribe(){
+	s_battery_handler = NULL;
+}
+
+void accel_tap_service_subscribe(AccelTapHandler handler){
+	s_tap_handler = handler;
+}
+
+void accel_tap_service_unsubscribe(){
+	s_tap_handler = NULL;
+}
+
+void fake_tap(){
+	if(s_tap_handler)
+		s_tap_handler(ACCEL_AXIS_Z, 1);
+}
+
+
+/*
+	Worker
+	========================================================================================
+*/
+bool app_worker_is_running(){
+	return s_worker_running;
+}
+
+AppWorkerResult app_worker_launch(){
+	fake_counts.worker_launches++;
+
+	if(s_worker_running)
+		return APP_WORKER_RESULT_ALREADY_RUNNING;
+
+	s_worker_running = s_worker_result == APP_WORKER_RESULT_SUCCESS;
+	return s_worker_result;
+}
+
+AppWorkerResult app_worker_kill(){
+	if(!s_worker_running)
+		return APP_WORKER_RESULT_NOT_RUNNING;
+
+	s_worker_running = false;
+	return APP_WORKER_RESULT_SUCCESS;
+}
+
+bool app_worker_message_subscribe(AppWorkerMessageHandler handler){
+	s_worker_handler = handler;
+	return true;
+}
+
+bool app_worker_message_unsubscribe(){
+	s_worker_handler = NULL;
+	return true;
+}
+
+// Only one side runs at a time on the host, messages to the other are only counted
+void app_worker_send_message(uint8_t type, AppWorkerMessage *data){
+	fake_counts.worker_messages++;
+}
+
+// The worker's loop is the scenario too
+void worker_event_loop(){
+	if(s_scenario)
+		s_scenario();
+}
+
+void worker_launch_app(){
+	if(fake_counts.app_launches < FAKE_MAX_APP_LAUNCHES)
+		fake_app_launches[fake_counts.app_launches] = s_now_ms;
+	fake_counts.app_launches++;
+}
+
+
+/*
+	AppMessage
+	========================================================================================
+*/
+AppMessageResult app_message_open(uint32_t size_inbound, uint32_t size_outbound){
+	s_message_open = true;
+	return APP_MSG_OK;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback){
+	AppMessageOutboxSent previous = s_sent_callback;
+	s_sent_callback = sent_callback;
+	return previous;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback){
+	AppMessageOutboxFailed previous = s_failed_callback;
+	s_failed_callback = failed_callback;
+	return previous;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator){
+	if(!s_message_open || s_outbox.message)
+		return APP_MSG_BUSY;
+
+	// Past the log, the last message keeps being reused
+	uint32_t index = fake_counts.messages < FAKE_MAX_MESSAGES ? fake_counts.messages : FAKE_MAX_MESSAGES - 1;
+	s_outbox.message = &fake_messages[index];
+	memset(s_outbox.message, 0, sizeof(FakeMessage));
+	*iterator = &s_outbox;
+	return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(){
+	if(s_outbox.message == NULL)
+		return APP_MSG_BUSY;
+
+	s_outbox.message->time_ms = s_now_ms;
+	s_outbox_due_ms = s_now_ms + FAKE_MESSAGE_MS;
+	fake_counts.messages++;
+	return APP_MSG_OK;
+}
+
+// The phone answers a while after each send
+static void ackOutbox(){
+	s_outbox_due_ms = -1;
+	s_outbox.message = NULL;
+
+	if(s_connected){
+		if(s_sent_callback)
+			s_sent_callback(&s_outbox, NULL);
+	}else{
+		if(s_failed_callback)
+			s_failed_callback(&s_outbox, APP_MSG_NOT_CONNECTED, NULL);
+	}
+}
+
+static DictionaryResult writeValue(DictionaryIterator *iter, uint32_t key, int32_t value, uint16_t length){
+	FakeMessage *message = iter->message;
+	if(message->num_keys < FAKE_MAX_MESSAGE_KEYS){
+		message->keys[message->num_keys] = key;
+		message->values[message->num_keys] = value;
+		message->lengths[message->num_keys] = length;
+		message->num_keys++;
+	}
+	return DICT_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, uint32_t key, const uint8_t *data, uint16_t size){
+	memcpy(iter->message->data, data, size < FAKE_MAX_MESSAGE_DATA ? size : FAKE_MAX_MESSAGE_DATA);
+	return writeValue(iter, key, size, size);
+}
+
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, uint32_t key, uint8_t value){
+	return writeValue(iter, key, value, sizeof(value));
+}
+
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, uint32_t key, uint16_t value){
+	return writeValue(iter, key, value, sizeof(value));
+}
+
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, uint32_t key, uint32_t value){
+	return writeValue(iter, key, (int32_t) value, sizeof(value));
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator *iter, uint32_t key, int32_t value){
+	return writeValue(iter, key, value, sizeof(value));
+}
+
+
+/*
+	Layers
+	========================================================================================
+*/
+Layer* layer_create_with_data(GRect frame, size_t data_size){
+	Layer *layer = fakeAlloc(sizeof(Layer) + data_size);
+	layer->frame = frame;
+	return layer;
+}
+
+static void removeFromParent(Layer *layer){
+	if(layer->parent == NULL)
+		return;
+
+	for(Layer **link = &layer->parent->children; *link; link = &(*link)->next_sibling){
+		if(*link == layer){
+			*link = layer->next_sibling;
+			break;
+		}
+	}
+	layer->parent = NULL;
+	layer->next_sibling = NULL;
+}
+
+void layer_destroy(Layer *layer){
+	if(layer == NULL)
+		return;
+
+	removeFromParent(layer);
+	for(Layer *child = layer->children; child; child = child->next_sibling)
+		child->parent = NULL;
+
+	fakeFree(layer);
+}
+
+void* layer_get_data(const Layer *layer){
+	return (void *) layer->data;
+}
+
+GRect layer_get_frame(const Layer *layer){
+	return layer->frame;
+}
+
+GRect layer_get_bounds(const Layer *layer){
+	return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc){
+	layer->update_proc = update_proc;
+}
+
+// Children are drawn in the order they were added
+void layer_add_child(Layer *parent, Layer *child){
+	removeFromParent(child);
+
+	Layer **link = &parent->children;
+	while(*link)
+		link = &(*link)->next_sibling;
+
+	*link = child;
+	child->parent = parent;
+}
+
+Layer* fake_layer_child(const Layer *layer, uint8_t index){
+	Layer *child = layer->children;
+	while(child && index--)
+		child = child->next_sibling;
+	return child;
+}
+
+void layer_mark_dirty(Layer *layer){
+	fake_counts.layer_dirties++;
+	layer->dirty = true;
+}
+
+static bool anyDirty(Layer *layer){
+	if(layer->dirty)
+		return true;
+
+	for(Layer *child = layer->children; child; child = child->next_sibling){
+		if(anyDirty(child))
+			return true;
+	}
+	return false;
+}
+
+// Like the watch, anything dirty redraws every layer of the window
+static uint32_t drawTree(Layer *layer){
+	uint32_t drawn = 0;
+	layer->dirty = false;
+
+	if(layer->update_proc){
+		layer->update_proc(layer, NULL);
+		drawn++;
+	}
+
+	for(Layer *child = layer->children; child; child = child->next_sibling)
+		drawn += drawTree(child);
+
+	return drawn;
+}
+
+static void drawMenu(MenuLayer *menu);
+
+uint32_t fake_render(){
+	Window *window = fake_top_window();
+	if(window == NULL || !anyDirty(window->root))
+		return 0;
+
+	uint32_t drawn = drawTree(window->root);
+	if(window->menu)
+		drawMenu(window->menu);
+
+	fake_counts.layer_draws += drawn;
+	return drawn;
+}
+
+TextLayer* text_layer_create(GRect frame){
+	TextLayer *text_layer = fakeAlloc(sizeof(TextLayer));
+	text_layer->layer = layer_create_with_data(frame, 0);
+	return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer){
+	if(text_layer == NULL)
+		return;
+
+	layer_destroy(text_layer->layer);
+	fakeFree(text_layer);
+}
+
+Layer* text_layer_get_layer(TextLayer *text_layer){
+	return text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text){
+	fake_counts.text_sets++;
+	text_layer->text = text;
+	layer_mark_dirty(text_layer->layer);
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font){
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment){
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color){
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color){
+}
+
+GFont fonts_get_system_font(const char *font_key){
+	return NULL;
+}
+
+ActionBarLayer* action_bar_layer_create(){
+	ActionBarLayer *action_bar = fakeAlloc(sizeof(ActionBarLayer));
+	action_bar->layer = layer_create_with_data(GRect(144 - 30, 0, 30, 168), 0);
+	return action_bar;
+}
+
+void action_bar_layer_destroy(ActionBarLayer *action_bar){
+	if(action_bar == NULL)
+		return;
+
+	layer_destroy(action_bar->layer);
+	fakeFree(action_bar);
+}
+
+void action_bar_layer_add_to_window(ActionBarLayer *action_bar, Window *window){
+	action_bar->window = window;
+	layer_add_child(window->root, action_bar->layer);
+}
+
+// The action bar takes the clicks of the window it is in
+void action_bar_layer_set_click_config_provider(ActionBarLayer *action_bar, ClickConfigProvider click_config_provider){
+	if(action_bar->window){
+		action_bar->window->click_config_provider = click_config_provider;
+		action_bar->window->click_context = action_bar;
+	}
+}
+
+void action_bar_layer_set_icon(ActionBarLayer *action_bar, ButtonId button_id, const GBitmap *icon){
+	if(action_bar->icons[button_id] == icon)
+		return;
+
+	action_bar->icons[button_id] = icon;
+	layer_mark_dirty(action_bar->layer);
+}
+
+
+/*
+	Menus
+	========================================================================================
+*/
+MenuLayer* menu_layer_create(GRect frame){
+	MenuLayer *menu = fakeAlloc(sizeof(MenuLayer));
+	menu->layer = layer_create_with_data(frame, 0);
+	return menu;
+}
+
+void menu_layer_destroy(MenuLayer *menu){
+	if(menu == NULL)
+		return;
+
+	layer_destroy(menu->layer);
+	fakeFree(menu);
+}
+
+Layer* menu_layer_get_layer(const MenuLayer *menu){
+	return menu->layer;
+}
+
+void menu_layer_set_callbacks(MenuLayer *menu, void *callback_context, MenuLayerCallbacks callbacks){
+	menu->callbacks = callbacks;
+	menu->context = callback_context;
+}
+
+void menu_layer_set_click_config_onto_window(MenuLayer *menu, Window *window){
+	window->menu = menu;
+}
+
+void menu_layer_reload_data(MenuLayer *menu){
+	layer_mark_dirty(menu->layer);
+}
+
+static uint16_t numRows(MenuLayer *menu, uint16_t section){
+	return menu->callbacks.get_num_rows ? menu->callbacks.get_num_rows(menu, section, menu->context) : 0;
+}
+
+static uint16_t numSections(MenuLayer *menu){
+	return menu->callbacks.get_num_sections ? menu->callbacks.get_num_sections(menu, menu->context) : 1;
+}
+
+// Every row is drawn, and its titles kept for tests
+static void drawMenu(MenuLayer *menu){
+	memset(s_menu_titles, 0, sizeof(s_menu_titles));
+	memset(s_menu_subtitles, 0, sizeof(s_menu_subtitles));
+
+	for(uint16_t section = 0; section < numSections(menu) && section < MAX_MENU_SECTIONS; section++){
+		if(menu->callbacks.draw_header)
+			menu->callbacks.draw_header(NULL, menu->layer, section, menu->context);
+
+		for(uint16_t row = 0; row < numRows(menu, section) && row < MAX_MENU_ROWS; row++){
+			s_drawing_row = (MenuIndex) { .section = section, .row = row };
+			menu->callbacks.draw_row(NULL, menu->layer, &s_drawing_row, menu->context);
+		}
+	}
+}
+
+// Titles only last as long as the row's drawing, so they are copied
+void menu_cell_basic_draw(GContext *ctx, const Layer *cell_layer, const char *title, const char *subtitle, GBitmap *icon){
+	static char s_titles[MAX_MENU_SECTIONS][MAX_MENU_ROWS][48];
+	static char s_subtitles[MAX_MENU_SECTIONS][MAX_MENU_ROWS][48];
+	uint16_t section = s_drawing_row.section;
+	uint16_t row = s_drawing_row.row;
+
+	snprintf(s_titles[section][row], sizeof(s_titles[section][row]), "%s", title ? title : "");
+	snprintf(s_subtitles[section][row], sizeof(s_subtitles[section][row]), "%s", subtitle ? subtitle : "");
+	s_menu_titles[section][row] = s_titles[section][row];
+	s_menu_subtitles[section][row] = s_subtitles[section][row];
+}
+
+void menu_cell_basic_header_draw(GContext *ctx, const Layer *cell_layer, const char *title){
+}
+
+const char* fake_menu_title(uint16_t section, uint16_t row){
+	return section < MAX_MENU_SECTIONS && row < MAX_MENU_ROWS ? s_menu_titles[section][row] : NULL;
+}
+
+const char* fake_menu_subtitle(uint16_t section, uint16_t row){
+	return section < MAX_MENU_SECTIONS && row < MAX_MENU_ROWS ? s_menu_subtitles[section][row] : NULL;
+}
+
+// Up and down move through the rows and on into the next section
+static void menuClick(MenuLayer *menu, ButtonId button){
+	MenuIndex *index = &menu->selected;
+
+	if(button == BUTTON_ID_SELECT){
+		if(menu->callbacks.select_click)
+			menu->callbacks.select_click(menu, index, menu->context);
+		return;
+	}
+
+	if(button == BUTTON_ID_DOWN){
+		if(index->row + 1 < numRows(menu, index->section)){
+			index->row++;
+		}else if(index->section + 1 < numSections(menu)){
+			index->section++;
+			index->row = 0;
+		}
+	}else if(button == BUTTON_ID_UP){
+		if(index->row > 0){
+			index->row--;
+		}else if(index->section > 0){
+			index->section--;
+			index->row = numRows(menu, index->section) - 1;
+		}
+	}
+
+	layer_mark_dirty(menu->layer);
+}
+
+
+/*
+	Windows and Clicks
+	========================================================================================
+*/
+Window* window_create(){
+	Window *window = fakeAlloc(sizeof(Window));
+	window->root = layer_create_with_data(SCREEN_BOUNDS, 0);
+	return window;
+}
+
+static void removeFromStack(Window *window){
+	for(int i = 0; i < s_stack_size; i++){
+		if(s_stack[i] == window){
+			memmove(&s_stack[i], &s_stack[i + 1], (s_stack_size - i - 1) * sizeof(Window *));
+			s_stack_size--;
+			return;
+		}
+	}
+}
+
+void window_destroy(Window *window){
+	if(window == NULL)
+		return;
+
+	removeFromStack(window);
+	layer_destroy(window->root);
+	fakeFree(window);
+}
+
+Layer* window_get_root_layer(const Window *window){
+	return window->root;
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers){
+	window->handlers = handlers;
+}
+
+void window_set_click_config_provider(Window *window, ClickConfigProvider click_config_provider){
+	window->click_config_provider = click_config_provider;
+	window->click_context = window;
+}
+
+void window_single_click_subscribe(ButtonId button_id, ClickHandler handler){
+	if(s_configuring)
+		s_configuring->single[button_id] = handler;
+}
+
+void window_single_repeating_click_subscribe(ButtonId button_id, uint16_t repeat_interval_ms, ClickHandler handler){
+	if(s_configuring)
+		s_configuring->repeating[button_id] = handler;
+}
+
+uint8_t click_number_of_clicks_counted(ClickRecognizerRef recognizer){
+	return ((FakeRecognizer *) recognizer)->count;
+}
+
+Window* fake_top_window(){
+	return s_stack_size > 0 ? s_stack[s_stack_size - 1] : NULL;
+}
+
+uint8_t fake_stack_size(){
+	return s_stack_size;
+}
+
+bool window_stack_contains_window(Window *window){
+	for(int i = 0; i < s_stack_size; i++){
+		if(s_stack[i] == window)
+			return true;
+	}
+	return false;
+}
+
+void window_stack_push(Window *window, bool animated){
+	Window *covered = fake_top_window();
+	fake_counts.window_pushes++;
+
+	removeFromStack(window);
+	s_stack[s_stack_size++] = window;
+
+	if(covered && covered != window && covered->handlers.disappear)
+		covered->handlers.disappear(covered);
+
+	if(!window->loaded){
+		window->loaded = true;
+		if(window->handlers.load)
+			window->handlers.load(window);
+	}
+
+	if(window->handlers.appear)
+		window->handlers.appear(window);
+
+	layer_mark_dirty(window->root);
+}
+
+// Take the top window off, uncovering the next one unless everything is going
+static Window* popTop(bool uncover){
+	Window *window = fake_top_window();
+	if(window == NULL)
+		return NULL;
+
+	fake_counts.window_pops++;
+	s_stack_size--;
+
+	if(window->handlers.disappear)
+		window->handlers.disappear(window);
+
+	window->loaded = false;
+	if(window->handlers.unload)
+		window->handlers.unload(window);
+
+	Window *uncovered = fake_top_window();
+	if(uncover && uncovered){
+		if(uncovered->handlers.appear)
+			uncovered->handlers.appear(uncovered);
+		layer_mark_dirty(uncovered->root);
+	}
+
+	return window;
+}
+
+Window* window_stack_pop(bool animated){
+	return popTop(true);
+}
+
+void window_stack_pop_all(bool animated){
+	while(s_stack_size > 0)
+		popTop(false);
+}
+
+// Click handlers are set up the way the watch does it, from the top window's provider
+static void configureClicks(Window *window){
+	memset(window->single, 0, sizeof(window->single));
+	memset(window->repeating, 0, sizeof(window->repeating));
+
+	if(window->click_config_provider){
+		s_configuring = window;
+		window->click_config_provider(window->click_context);
+		s_configuring = NULL;
+	}
+}
+
+// Pick a row and select it, like scrolling to it would
+void fake_menu_click(uint16_t section, uint16_t row){
+	Window *window = fake_top_window();
+	if(window == NULL || window->menu == NULL)
+		return;
+
+	window->menu->selected = (MenuIndex) { .section = section, .row = row };
+	menuClick(window->menu, BUTTON_ID_SELECT);
+}
+
+void fake_press(ButtonId button){
+	fake_hold(button, 1);
+}
+
+// Back without a handler pops the window, like the system does
+void fake_hold(ButtonId button, uint8_t repeats){
+	Window *window = fake_top_window();
+	if(window == NULL)
+		return;
+
+	configureClicks(window);
+
+	if(window->menu && button != BUTTON_ID_BACK){
+		menuClick(window->menu, button);
+		return;
+	}
+
+	ClickHandler handler = window->repeating[button] ? window->repeating[button] : window->single[button];
+	if(handler == NULL){
+		if(button == BUTTON_ID_BACK)
+			window_stack_pop(true);
+		return;
+	}
+
+	// A single click handler only fires once however long it is held
+	uint8_t count = window->repeating[button] ? repeats : 1;
+	for(uint8_t i = 1; i <= count; i++){
+		FakeRecognizer recognizer = { .count = i };
+		handler(&recognizer, window->click_context);
+	}
+}
+
+
+/*
+	Bitmaps and Drawing
+	========================================================================================
+*/
+GBitmap* gbitmap_create_with_resource(uint32_t resource_id){
+	GBitmap *bitmap = fakeAlloc(sizeof(GBitmap) + ICON_BYTES_PER_ROW * ICON_SIZE);
+	bitmap->resource_id = resource_id;
+	fake_counts.bitmap_loads++;
+	return bitmap;
+}
+
+void gbitmap_destroy(GBitmap *bitmap){
+	fakeFree(bitmap);
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap){
+	return GRect(0, 0, ICON_SIZE, ICON_SIZE);
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap){
+	return ICON_BYTES_PER_ROW;
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color){
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color){
+}
+
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t stroke_width){
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask){
+}
+
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius){
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1){
+}
+
+int32_t sin_lookup(int32_t angle){
+	return (int32_t) lround(sin(angle * 2 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t cos_lookup(int32_t angle){
+	return (int32_t) lround(cos(angle * 2 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
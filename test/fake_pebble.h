@@ -0,0 +1,131 @@
+/*
+ * fake_pebble.h
+ *
+ * Drives the fake services behind test/pebble.h: run the app, press buttons,
+ * let simulated time pass, and read back every call it made.
+ */
+
+#ifndef FAKE_PEBBLE_H_
+#define FAKE_PEBBLE_H_
+
+#include <pebble.h>
+
+// Wall clock at the start of every run, a Sunday in October 2026
+#define FAKE_EPOCH 1792281600
+
+// How long the phone takes to acknowledge a message
+#define FAKE_MESSAGE_MS 200
+
+// Most of each that are kept for tests to look at
+#define FAKE_MAX_VIBES 256
+#define FAKE_MAX_MESSAGES 64
+#define FAKE_MAX_MESSAGE_KEYS 8
+#define FAKE_MAX_MESSAGE_DATA 256
+#define FAKE_MAX_WAKEUPS 8
+#define FAKE_MAX_APP_LAUNCHES 64
+
+// Every call the app made, reset by fake_reset()
+typedef struct {
+	uint32_t wakeups;           // Tick handlers and app timers run
+	uint32_t ticks;
+	uint32_t timer_fires;
+	uint32_t tick_subscribes;
+	uint32_t timers_registered;
+	uint32_t persist_reads;     // persist_read_* and persist_exists
+	uint32_t persist_writes;    // persist_write_* and persist_delete
+	uint32_t vibes;
+	uint32_t layer_dirties;
+	uint32_t layer_draws;
+	uint32_t text_sets;
+	uint32_t window_pushes;
+	uint32_t window_pops;
+	uint32_t bitmap_loads;
+	uint32_t messages;
+	uint32_t wakeups_scheduled;
+	uint32_t worker_launches;
+	uint32_t worker_messages;   // app_worker_send_message, the app to the worker
+	uint32_t app_launches;      // worker_launch_app, the worker opening the app
+	size_t heap_high_water;
+} FakeCounts;
+
+// A vibration, with when it started on the fake clock
+typedef struct {
+	int64_t time_ms;
+	uint32_t num_segments;
+	uint32_t durations[8];
+} FakeVibe;
+
+// An AppMessage sent to the phone
+typedef struct {
+	int64_t time_ms;
+	uint8_t num_keys;
+	uint32_t keys[FAKE_MAX_MESSAGE_KEYS];
+	int32_t values[FAKE_MAX_MESSAGE_KEYS];
+	uint16_t lengths[FAKE_MAX_MESSAGE_KEYS];
+	uint8_t data[FAKE_MAX_MESSAGE_DATA];   // Bytes of the data value, the value is its length
+} FakeMessage;
+
+// A wakeup scheduled with the system
+typedef struct {
+	time_t time;
+	int32_t cookie;
+} FakeWakeup;
+
+extern FakeCounts fake_counts;
+extern FakeVibe fake_vibes[FAKE_MAX_VIBES];
+extern FakeMessage fake_messages[FAKE_MAX_MESSAGES];
+extern FakeWakeup fake_wakeups[FAKE_MAX_WAKEUPS];
+extern uint8_t fake_num_wakeups;
+
+// When the worker opened the app, on the fake clock
+extern int64_t fake_app_launches[FAKE_MAX_APP_LAUNCHES];
+
+// Failed checks, kept here so the ones made inside a launch count too
+extern uint32_t fake_check_failures;
+
+// Start over: clock back to FAKE_EPOCH, counts cleared. Storage is only
+// wiped when asked, so one run can pick up what the last one stored.
+void fake_reset(bool wipe_storage);
+
+// Run main() with scenario as the body of the event loop, the app's or the
+// worker's. The launch gets a process of its own, counts and storage come
+// back once main() returns.
+void fake_run(int (*app_main)(void), void (*scenario)(void));
+
+// Let time pass, running every tick and timer due on the way
+void fake_advance_ms(int64_t ms);
+int64_t fake_now_ms(void);
+
+// Buttons go to the top window. Holding calls a repeating handler repeats times.
+void fake_press(ButtonId button);
+void fake_hold(ButtonId button, uint8_t repeats);
+void fake_tap(void);
+void fake_menu_click(uint16_t section, uint16_t row);
+
+// Draw every dirty layer of the top window, returns how many were drawn
+uint32_t fake_render(void);
+
+Window* fake_top_window(void);
+Layer* fake_layer_child(const Layer *layer, uint8_t index);
+uint8_t fake_stack_size(void);
+bool fake_ticks_subscribed(TimeUnits *unit);
+uint32_t fake_timers_pending(void);
+size_t fake_heap_bytes(void);
+
+// Titles drawn by the last menu render
+const char* fake_menu_title(uint16_t section, uint16_t row);
+const char* fake_menu_subtitle(uint16_t section, uint16_t row);
+
+// What the system, battery, worker and phone look like to the app
+void fake_set_launch(AppLaunchReason reason, int32_t wakeup_cookie);
+void fake_set_battery(uint8_t percent, bool charging);
+void fake_set_worker(AppWorkerResult launch_result);
+void fake_set_wakeups_available(bool available);
+void fake_set_connected(bool connected);
+void fake_set_storage_full(bool full);
+
+// Raw access to fake storage
+bool fake_persist_get(uint32_t key, void *buffer, size_t size);
+void fake_persist_set(uint32_t key, const void *data, size_t size);
+
+#endif /* FAKE_PEBBLE_H_ */
@@ -0,0 +1,169 @@
+/*
+ * Feeds Presenter.receive the messages Presenter.c sends and checks the time
+ * the phone shows from them, with a stand-in clock.
+ *
+ *   node test/js/presenter.test.js
+ */
+var assert = require('assert');
+var vm = require('vm');
+
+// What the phone provides, kept in memory
+var storage = {};
+global.localStorage = {
+  setItem: function (key, value) { storage[key] = String(value); },
+  getItem: function (key) { return key in storage ? storage[key] : null; }
+};
+
+var logged = [];
+var log = console.log;
+console.log = function (line) { logged.push(line); };
+
+var Presenter = require('../../src/js/presenter.js');
+
+// Matches Presenter.h
+var STATE = { stopped: 0, running: 1, paused: 2 };
+
+// Watch and phone clocks agree unless a test says otherwise
+var T = 1792281600;
+var SECOND = 1000;
+var MINUTE = 60 * SECOND;
+
+// Like Presenter.c: the anchor is whole seconds, the milliseconds past it are
+// added to the time left while running
+function message(state, remainingMs, atMs, extra) {
+  var payload = {
+    PRESENTER_STATE: state,
+    PRESENTER_ANCHOR: Math.floor(atMs / 1000),
+    PRESENTER_REMAINING: state === STATE.running ? remainingMs + atMs % 1000 : remainingMs
+  };
+  for (var key in extra) {
+    payload[key] = extra[key];
+  }
+  return payload;
+}
+
+var tests = [];
+function test(name, body) { tests.push({ name: name, body: body }); }
+
+test('a start counts down from its anchor', function () {
+  var sent = T * SECOND + 250;
+  Presenter.receive(message(STATE.running, 5 * MINUTE, sent, { PRESENTER_SEGMENT: 0, PRESENTER_TOTAL: 300 }), sent + 40);
+
+  assert.strictEqual(Presenter.remaining(sent + 40), 5 * MINUTE - 40);
+  assert.strictEqual(Presenter.format(Presenter.remaining(sent + 40)), '5:00');
+  // Rounded up like the watch, 4:00 shows until the whole second has gone
+  assert.strictEqual(Presenter.format(Presenter.remaining(sent + MINUTE + SECOND - 1)), '4:00');
+  assert.strictEqual(Presenter.format(Presenter.remaining(sent + MINUTE + SECOND)), '3:59');
+
+  var stored = JSON.parse(localStorage.getItem('presenter'));
+  assert.strictEqual(stored.state, 'running');
+  assert.strictEqual(stored.total, 300);
+  assert.strictEqual(stored.endAt, sent + 5 * MINUTE);
+  assert.deepStrictEqual(logged, ['Presenter: running, segment 0, 5:00']);
+});
+
+test('a pause holds the time and keeps what was not sent', function () {
+  var sent = T * SECOND;
+  Presenter.receive(message(STATE.running, 5 * MINUTE, sent, { PRESENTER_SEGMENT: 1, PRESENTER_TOTAL: 600 }), sent);
+  Presenter.receive(message(STATE.paused, 3 * MINUTE + 20 * SECOND, sent + 100 * SECOND), sent + 100 * SECOND);
+
+  assert.strictEqual(Presenter.remaining(sent + 100 * SECOND), 200 * SECOND);
+  assert.strictEqual(Presenter.remaining(sent + 60 * MINUTE), 200 * SECOND);
+  assert.strictEqual(Presenter.format(Presenter.remaining()), '3:20');
+
+  var stored = JSON.parse(localStorage.getItem('presenter'));
+  assert.strictEqual(stored.state, 'paused');
+  assert.strictEqual(stored.segment, 1);
+  assert.strictEqual(stored.total, 600);
+});
+
+test('overtime counts up past zero without another message', function () {
+  var sent = T * SECOND + 500;
+  Presenter.receive(message(STATE.running, -5 * SECOND, sent), sent);
+
+  assert.strictEqual(Presenter.remaining(sent), -5 * SECOND);
+  assert.strictEqual(Presenter.format(Presenter.remaining(sent)), '+0:05');
+  assert.strictEqual(Presenter.format(Presenter.remaining(sent + MINUTE)), '+1:05');
+  assert.strictEqual(Presenter.format(-999), '+0:00');
+  assert.strictEqual(Presenter.format(1), '0:01');
+});
+
+test('clocks too far apart fall back to when the message arrived', function () {
+  var sent = T * SECOND;
+
+  // Just inside MAX_SKEW the watch's anchor is trusted
+  Presenter.receive(message(STATE.running, MINUTE, sent), sent + 1999);
+  assert.strictEqual(Presenter.remaining(sent + 1999), MINUTE - 1999);
+
+  // Ten minutes out, the minute counts from arrival
+  Presenter.receive(message(STATE.running, MINUTE, sent + 10 * MINUTE), sent);
+  assert.strictEqual(Presenter.remaining(sent), MINUTE);
+  assert.strictEqual(Presenter.remaining(sent + 30 * SECOND), 30 * SECOND);
+
+  // Behind by as much as well
+  Presenter.receive(message(STATE.running, MINUTE, sent - 2 * SECOND), sent);
+  assert.strictEqual(Presenter.remaining(sent), MINUTE);
+});
+
+// Runs the page's script with a stand-in document and clock, returns the
+// time shown after each poll
+function openPage(now) {
+  var html = decodeURIComponent(Presenter.page().replace('data:text/html,', ''));
+  var script = html.slice(html.indexOf('<script>') + 8, html.indexOf('</script>'));
+  var shown = { textContent: '', style: {} };
+  var page = {
+    poll: null,
+    now: now,
+    shown: function () { page.poll(); return shown.textContent; }
+  };
+  vm.runInNewContext(script, {
+    localStorage: global.localStorage,
+    document: { getElementById: function () { return shown; } },
+    Date: { now: function () { return page.now; } },
+    setInterval: function (poll) { page.poll = poll; }
+  });
+  return page;
+}
+
+test('the page starts from what was last received', function () {
+  var sent = T * SECOND;
+  Presenter.receive(message(STATE.paused, 90 * SECOND, sent), sent);
+
+  var page = openPage(sent + MINUTE);
+  assert.strictEqual(page.shown(), '1:30');
+});
+
+test('the page keeps up with messages after it opens', function () {
+  var sent = T * SECOND;
+  Presenter.receive(message(STATE.running, 2 * MINUTE, sent), sent);
+  var page = openPage(sent);
+  assert.strictEqual(page.shown(), '2:00');
+
+  // Counts down on its own
+  page.now = sent + 30 * SECOND;
+  assert.strictEqual(page.shown(), '1:30');
+
+  // Paused on the watch, the page holds where it was told
+  Presenter.receive(message(STATE.paused, 80 * SECOND, sent + 40 * SECOND), sent + 40 * SECOND);
+  page.now = sent + 50 * SECOND;
+  assert.strictEqual(page.shown(), '1:20');
+
+  // Running again, counted from the anchor like the phone does, into overtime
+  Presenter.receive(message(STATE.running, 80 * SECOND, sent + MINUTE), sent + MINUTE + 500);
+  page.now = sent + 3 * MINUTE;
+  assert.strictEqual(page.shown(), '+0:40');
+});
+
+var failed = 0;
+tests.forEach(function (t) {
+  logged = [];
+  storage = {};
+  try {
+    t.body();
+    log('pass ' + t.name);
+  } catch (e) {
+    failed++;
+    log('FAIL ' + t.name + '\n' + e.message);
+  }
+});
+process.exit(failed ? 1 : 0);
@@ -0,0 +1,137 @@
+/*
+ * Feeds packed session records through SessionLog.receive the way the watch
+ * sends them, in batches, and checks the talks that come out.
+ *
+ *   node test/js/session-log.test.js
+ */
+var assert = require('assert');
+
+// What the phone provides, kept in memory
+var storage = {};
+global.localStorage = {
+  setItem: function (key, value) { storage[key] = String(value); },
+  getItem: function (key) { return key in storage ? storage[key] : null; }
+};
+
+var logged = [];
+var log = console.log;
+console.log = function (line) { logged.push(line); };
+
+var SessionLog = require('../../src/js/session-log.js');
+
+// Matches SessionLog.h
+var BATCH = 16;
+var EVENT = { start: 0, pause: 1, resume: 2, restart: 3, cue: 4, segment: 5, timeUp: 6, stop: 7 };
+var CUE = { interval: 1, finalWarning: 2, lastTen: 3, timeUp: 4 };
+
+// Little endian uint32 time, uint16 value, uint8 event, uint8 detail
+function record(time, value, event, detail) {
+  return [time & 0xFF, time >>> 8 & 0xFF, time >>> 16 & 0xFF, time >>> 24 & 0xFF,
+    value & 0xFF, value >> 8 & 0xFF, event, detail || 0];
+}
+
+// Send records like SessionLog.c does, BATCH at a time with the offset and total
+function send(records) {
+  for (var offset = 0; offset === 0 || offset < records.length; offset += BATCH) {
+    SessionLog.receive({
+      LOG_RECORDS: [].concat.apply([], records.slice(offset, offset + BATCH)),
+      LOG_OFFSET: offset,
+      LOG_TOTAL: records.length
+    });
+  }
+}
+
+var T = 1792281600;
+var tests = [];
+function test(name, body) { tests.push({ name: name, body: body }); }
+
+test('a talk split over batches comes back whole', function () {
+  var records = [record(T, 300, EVENT.start)];
+  for (var i = 1; i <= 20; i++) {
+    records.push(record(T + i * 10, 300 - i * 10, EVENT.cue, CUE.interval));
+  }
+  records.push(record(T + 300, 0, EVENT.timeUp));
+  records.push(record(T + 345, 45, EVENT.stop));
+
+  storage = {};
+  send(records);
+
+  var received = JSON.parse(localStorage.getItem('sessionLog'));
+  assert.strictEqual(received.length, 23);
+  assert.deepStrictEqual(received[1], { time: T + 10, value: 290, event: 'cue', cue: 'interval' });
+
+  var sessions = SessionLog.sessions(received);
+  assert.strictEqual(sessions.length, 1);
+  assert.strictEqual(sessions[0].start, T);
+  assert.strictEqual(sessions[0].end, T + 345);
+  assert.strictEqual(sessions[0].cues.length, 20);
+  assert.strictEqual(sessions[0].timeUp, true);
+  assert.strictEqual(sessions[0].overrun, 45);
+
+  // Reported once, when the last batch is in
+  assert.strictEqual(logged.length, 1);
+  assert.ok(/^Session .*: 345s, 0 pauses \(0s\), overrun 45s/.test(logged[0]), logged[0]);
+});
+
+test('nothing is stored until the last batch is in', function () {
+  var records = [];
+  for (var i = 0; i < BATCH + 1; i++) {
+    records.push(record(T + i, 0, EVENT.start));
+  }
+
+  storage = {};
+  SessionLog.receive({ LOG_RECORDS: [].concat.apply([], records.slice(0, BATCH)), LOG_OFFSET: 0, LOG_TOTAL: records.length });
+  assert.strictEqual(localStorage.getItem('sessionLog'), null);
+
+  SessionLog.receive({ LOG_RECORDS: records[BATCH], LOG_OFFSET: BATCH, LOG_TOTAL: records.length });
+  assert.strictEqual(JSON.parse(localStorage.getItem('sessionLog')).length, BATCH + 1);
+});
+
+test('pauses, segments and several talks', function () {
+  send([
+    record(T, 1200, EVENT.start),
+    record(T + 100, 1100, EVENT.pause),
+    record(T + 160, 1100, EVENT.resume),
+    record(T + 400, 760, EVENT.cue, CUE.finalWarning),
+    record(T + 1260, 600, EVENT.segment, 1),
+    record(T + 1500, 360, EVENT.stop, 1),
+    record(T + 2000, 300, EVENT.start),
+    record(T + 2100, 200, EVENT.stop)
+  ]);
+
+  var sessions = SessionLog.sessions(JSON.parse(localStorage.getItem('sessionLog')));
+  assert.strictEqual(sessions.length, 2);
+  assert.strictEqual(sessions[0].pauses, 1);
+  assert.strictEqual(sessions[0].paused, 60);
+  assert.deepStrictEqual(sessions[0].cues, ['final warning']);
+  assert.strictEqual(sessions[0].timeUp, false);
+  assert.strictEqual(sessions[0].overrun, 0);
+  assert.strictEqual(sessions[1].end - sessions[1].start, 100);
+});
+
+test('a new export starts the log over', function () {
+  send([record(T, 300, EVENT.start), record(T + 10, 290, EVENT.stop)]);
+  send([record(T + 50, 300, EVENT.start)]);
+
+  assert.strictEqual(JSON.parse(localStorage.getItem('sessionLog')).length, 1);
+});
+
+test('an empty log stores nothing to show', function () {
+  send([]);
+
+  assert.deepStrictEqual(JSON.parse(localStorage.getItem('sessionLog')), []);
+  assert.deepStrictEqual(SessionLog.sessions([]), []);
+});
+
+var failed = 0;
+tests.forEach(function (t) {
+  logged = [];
+  try {
+    t.body();
+    log('pass ' + t.name);
+  } catch (e) {
+    failed++;
+    log('FAIL ' + t.name + '\n' + e.message);
+  }
+});
+process.exit(failed ? 1 : 0);
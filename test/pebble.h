@@ -0,0 +1,315 @@
+/*
+ * pebble.h
+ *
+ * Host stand-in for the Pebble SDK header, just enough of it for src/ to
+ * build on Linux. Every service is faked in fake_pebble.c, which counts each
+ * call so tests can check exactly what the app does (see fake_pebble.h).
+ */
+
+#ifndef PEBBLE_H_
+#define PEBBLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+// The fake clock stands in for the wall clock
+time_t fake_time(time_t *tloc);
+#define time(tloc) fake_time(tloc)
+
+
+/*
+	Graphics Types
+	========================================================================================
+*/
+typedef struct { int16_t x, y; } GPoint;
+typedef struct { int16_t w, h; } GSize;
+typedef struct { GPoint origin; GSize size; } GRect;
+
+#define GPoint(x, y) ((GPoint) { (x), (y) })
+#define GSize(w, h) ((GSize) { (w), (h) })
+#define GRect(x, y, w, h) ((GRect) { { (x), (y) }, { (w), (h) } })
+
+typedef uint8_t GColor;
+#define GColorBlack ((GColor) 0)
+#define GColorWhite ((GColor) 1)
+
+typedef enum { GCornerNone = 0 } GCornerMask;
+
+typedef struct GContext GContext;
+typedef struct Layer Layer;
+typedef struct Window Window;
+typedef struct TextLayer TextLayer;
+typedef struct ActionBarLayer ActionBarLayer;
+typedef struct MenuLayer MenuLayer;
+typedef struct GBitmap GBitmap;
+typedef struct GFontStub *GFont;
+typedef struct AppTimer AppTimer;
+typedef struct DictionaryIterator DictionaryIterator;
+typedef void *ClickRecognizerRef;
+
+#define TRIG_MAX_ANGLE 0x10000
+#define TRIG_MAX_RATIO 0xffff
+
+#define FONT_KEY_GOTHIC_14 "RESOURCE_ID_GOTHIC_14"
+#define FONT_KEY_BITHAM_42_BOLD "RESOURCE_ID_BITHAM_42_BOLD"
+#define FONT_KEY_BITHAM_42_LIGHT "RESOURCE_ID_BITHAM_42_LIGHT"
+
+typedef enum { GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight } GTextAlignment;
+
+#define ARRAY_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
+
+/*
+	Resources
+	========================================================================================
+*/
+// In the order of appinfo.json
+enum {
+	RESOURCE_ID_IMAGE_SWITCH = 1,
+	RESOURCE_ID_IMAGE_MINUS2,
+	RESOURCE_ID_IMAGE_PLUS2,
+	RESOURCE_ID_IMAGE_PAUSE2,
+	RESOURCE_ID_IMAGE_PLAY2,
+	RESOURCE_ID_IMAGE_RESTART2,
+	RESOURCE_ID_IMAGE_SETTINGS2,
+};
+
+
+/*
+	Services
+	========================================================================================
+*/
+typedef enum { SECOND_UNIT = 1 << 0, MINUTE_UNIT = 1 << 1, HOUR_UNIT = 1 << 2 } TimeUnits;
+typedef enum { BUTTON_ID_BACK, BUTTON_ID_UP, BUTTON_ID_SELECT, BUTTON_ID_DOWN, NUM_BUTTONS } ButtonId;
+typedef enum { ACCEL_AXIS_X, ACCEL_AXIS_Y, ACCEL_AXIS_Z } AccelAxisType;
+
+typedef struct {
+	uint8_t charge_percent;
+	bool is_charging;
+	bool is_plugged;
+} BatteryChargeState;
+
+typedef struct {
+	const uint32_t *durations;
+	uint32_t num_segments;
+} VibePattern;
+
+typedef struct {
+	uint16_t data0;
+	uint16_t data1;
+	uint16_t data2;
+} AppWorkerMessage;
+
+typedef enum {
+	APP_WORKER_RESULT_SUCCESS,
+	APP_WORKER_RESULT_NO_WORKER,
+	APP_WORKER_RESULT_DIFFERENT_APP,
+	APP_WORKER_RESULT_NOT_RUNNING,
+	APP_WORKER_RESULT_ALREADY_RUNNING,
+	APP_WORKER_RESULT_ASKING_CONFIRMATION
+} AppWorkerResult;
+
+typedef enum {
+	APP_LAUNCH_SYSTEM,
+	APP_LAUNCH_USER,
+	APP_LAUNCH_PHONE,
+	APP_LAUNCH_WAKEUP,
+	APP_LAUNCH_WORKER
+} AppLaunchReason;
+
+typedef enum { APP_MSG_OK = 0, APP_MSG_SEND_TIMEOUT = 2, APP_MSG_NOT_CONNECTED = 8, APP_MSG_BUSY = 64 } AppMessageResult;
+typedef enum { DICT_OK = 0 } DictionaryResult;
+typedef int32_t WakeupId;
+
+#define APP_MESSAGE_INBOX_SIZE_MINIMUM 124
+#define APP_MESSAGE_OUTBOX_SIZE_MINIMUM 636
+#define PERSIST_DATA_MAX_LENGTH 256
+#define E_DOES_NOT_EXIST -4
+#define E_OUT_OF_STORAGE -6
+
+
+/*
+	Callbacks
+	========================================================================================
+*/
+typedef void (*WindowHandler)(Window *window);
+typedef struct {
+	WindowHandler load;
+	WindowHandler appear;
+	WindowHandler disappear;
+	WindowHandler unload;
+} WindowHandlers;
+
+typedef void (*ClickHandler)(ClickRecognizerRef recognizer, void *context);
+typedef void (*ClickConfigProvider)(void *context);
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+typedef void (*AppTimerCallback)(void *data);
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+typedef void (*AccelTapHandler)(AccelAxisType axis, int32_t direction);
+typedef void (*AppWorkerMessageHandler)(uint16_t type, AppWorkerMessage *data);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+typedef struct {
+	uint16_t section;
+	uint16_t row;
+} MenuIndex;
+
+typedef struct {
+	uint16_t (*get_num_sections)(MenuLayer *menu_layer, void *data);
+	uint16_t (*get_num_rows)(MenuLayer *menu_layer, uint16_t section_index, void *data);
+	int16_t (*get_header_height)(MenuLayer *menu_layer, uint16_t section_index, void *data);
+	void (*draw_header)(GContext *ctx, const Layer *cell_layer, uint16_t section_index, void *data);
+	void (*draw_row)(GContext *ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data);
+	void (*select_click)(MenuLayer *menu_layer, MenuIndex *cell_index, void *data);
+} MenuLayerCallbacks;
+
+#define MENU_CELL_BASIC_HEADER_HEIGHT 16
+#define ACTION_BAR_WIDTH 30
+
+
+/*
+	Logging
+	========================================================================================
+*/
+enum {
+	APP_LOG_LEVEL_ERROR = 1,
+	APP_LOG_LEVEL_WARNING = 50,
+	APP_LOG_LEVEL_INFO = 100,
+	APP_LOG_LEVEL_DEBUG = 200,
+};
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+	__attribute__((format(printf, 4, 5)));
+#define APP_LOG(level, fmt, ...) app_log(level, __FILE__, __LINE__, fmt, ## __VA_ARGS__)
+
+
+/*
+	API
+	========================================================================================
+*/
+// Event loop
+void app_event_loop(void);
+AppLaunchReason launch_reason(void);
+size_t heap_bytes_used(void);
+
+// Time
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms);
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer);
+WakeupId wakeup_schedule(time_t timestamp, int32_t cookie, bool notify_if_missed);
+void wakeup_cancel_all(void);
+bool wakeup_get_launch_event(WakeupId *wakeup_id, int32_t *cookie);
+
+// Storage
+bool persist_exists(uint32_t key);
+int persist_delete(uint32_t key);
+int persist_read_data(uint32_t key, void *buffer, size_t buffer_size);
+int32_t persist_read_int(uint32_t key);
+int persist_write_data(uint32_t key, const void *data, size_t size);
+int persist_write_int(uint32_t key, int32_t value);
+
+// Vibes, battery and taps
+void vibes_enqueue_custom_pattern(VibePattern pattern);
+void vibes_short_pulse(void);
+void vibes_long_pulse(void);
+void vibes_double_pulse(void);
+BatteryChargeState battery_state_service_peek(void);
+void battery_state_service_subscribe(BatteryStateHandler handler);
+void battery_state_service_unsubscribe(void);
+void accel_tap_service_subscribe(AccelTapHandler handler);
+void accel_tap_service_unsubscribe(void);
+
+// Worker
+bool app_worker_is_running(void);
+AppWorkerResult app_worker_launch(void);
+AppWorkerResult app_worker_kill(void);
+bool app_worker_message_subscribe(AppWorkerMessageHandler handler);
+bool app_worker_message_unsubscribe(void);
+void app_worker_send_message(uint8_t type, AppWorkerMessage *data);
+
+// AppMessage
+AppMessageResult app_message_open(uint32_t size_inbound, uint32_t size_outbound);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback);
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+DictionaryResult dict_write_data(DictionaryIterator *iter, uint32_t key, const uint8_t *data, uint16_t size);
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, uint32_t key, uint8_t value);
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, uint32_t key, uint16_t value);
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, uint32_t key, uint32_t value);
+DictionaryResult dict_write_int32(DictionaryIterator *iter, uint32_t key, int32_t value);
+
+// Windows and clicks
+Window* window_create(void);
+void window_destroy(Window *window);
+Layer* window_get_root_layer(const Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_click_config_provider(Window *window, ClickConfigProvider click_config_provider);
+void window_single_click_subscribe(ButtonId button_id, ClickHandler handler);
+void window_single_repeating_click_subscribe(ButtonId button_id, uint16_t repeat_interval_ms, ClickHandler handler);
+uint8_t click_number_of_clicks_counted(ClickRecognizerRef recognizer);
+void window_stack_push(Window *window, bool animated);
+Window* window_stack_pop(bool animated);
+void window_stack_pop_all(bool animated);
+bool window_stack_contains_window(Window *window);
+
+// Layers
+Layer* layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer *layer);
+void* layer_get_data(const Layer *layer);
+GRect layer_get_frame(const Layer *layer);
+GRect layer_get_bounds(const Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_mark_dirty(Layer *layer);
+
+TextLayer* text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer* text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+GFont fonts_get_system_font(const char *font_key);
+
+ActionBarLayer* action_bar_layer_create(void);
+void action_bar_layer_destroy(ActionBarLayer *action_bar);
+void action_bar_layer_add_to_window(ActionBarLayer *action_bar, Window *window);
+void action_bar_layer_set_click_config_provider(ActionBarLayer *action_bar, ClickConfigProvider click_config_provider);
+void action_bar_layer_set_icon(ActionBarLayer *action_bar, ButtonId button_id, const GBitmap *icon);
+
+MenuLayer* menu_layer_create(GRect frame);
+void menu_layer_destroy(MenuLayer *menu_layer);
+Layer* menu_layer_get_layer(const MenuLayer *menu_layer);
+void menu_layer_set_callbacks(MenuLayer *menu_layer, void *callback_context, MenuLayerCallbacks callbacks);
+void menu_layer_set_click_config_onto_window(MenuLayer *menu_layer, Window *window);
+void menu_layer_reload_data(MenuLayer *menu_layer);
+void menu_cell_basic_draw(GContext *ctx, const Layer *cell_layer, const char *title, const char *subtitle, GBitmap *icon);
+void menu_cell_basic_header_draw(GContext *ctx, const Layer *cell_layer, const char *title);
+
+// Bitmaps and drawing
+GBitmap* gbitmap_create_with_resource(uint32_t resource_id);
+void gbitmap_destroy(GBitmap *bitmap);
+GRect gbitmap_get_bounds(const GBitmap *bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t stroke_width);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+
+#endif /* PEBBLE_H_ */
@@ -0,0 +1,16 @@
+/*
+ * pebble_worker.h
+ *
+ * The worker's half of the SDK for host builds. It is a subset of the app's,
+ * so the same fakes stand behind it.
+ */
+
+#ifndef PEBBLE_WORKER_H_
+#define PEBBLE_WORKER_H_
+
+#include <pebble.h>
+
+void worker_event_loop(void);
+void worker_launch_app(void);
+
+#endif /* PEBBLE_WORKER_H_ */
@@ -0,0 +1,89 @@
+/*
+ * test_profile.c
+ *
+ * The app built with TIMR_PROFILE: the profiler and its debug window compile
+ * and run, and the first frame is measured against BUDGET_FIRST_FRAME_MS.
+ */
+
+#include <pebble.h>
+
+#include "check.h"
+#include "Timr.h"
+#include "Profiler.h"
+
+// Timr.c is built with its main renamed
+int timr_main(void);
+
+#define SECOND 1000
+
+
+/*
+	First frame
+	========================================================================================
+*/
+static void firstFrame(){
+	CHECK_EQ(profiler_first_frame_ms(), 0);
+
+	// Nothing on the host takes time, the launch is well inside the budget
+	fake_render();
+	CHECK(profiler_first_frame_ms() <= BUDGET_FIRST_FRAME_MS);
+}
+
+static void slowFirstFrame(){
+	// Drawn late, only the first frame counts
+	fake_advance_ms(BUDGET_FIRST_FRAME_MS + 50);
+	fake_render();
+	CHECK_EQ(profiler_first_frame_ms(), BUDGET_FIRST_FRAME_MS + 50);
+	CHECK(profiler_first_frame_ms() > BUDGET_FIRST_FRAME_MS);
+
+	fake_advance_ms(SECOND);
+	fake_press(BUTTON_ID_UP);
+	fake_render();
+	CHECK_EQ(profiler_first_frame_ms(), BUDGET_FIRST_FRAME_MS + 50);
+}
+
+// Launch to the first drawn digits, within BUDGET_FIRST_FRAME_MS
+static void test_first_frame_in_budget(){
+	fake_run(timr_main, firstFrame);
+	fake_reset(true);
+	fake_run(timr_main, slowFirstFrame);
+}
+
+
+/*
+	Debug window
+	========================================================================================
+*/
+static void openDebug(){
+	fake_advance_ms(20);
+	fake_render();
+
+	// The extra menu row, after Send Log
+	fake_press(BUTTON_ID_SELECT);
+	fake_menu_click(0, 4);
+	CHECK_EQ(fake_stack_size(), 3);
+	fake_render();
+	CHECK(strstr(profiler_summary(), "launch: 20ms") != NULL);
+
+	fake_press(BUTTON_ID_BACK);
+	fake_press(BUTTON_ID_BACK);
+	CHECK_EQ(fake_stack_size(), 1);
+}
+
+// The hidden screen opens from the menu, and everything is freed at exit
+static void test_debug_window_opens(){
+	fake_run(timr_main, openDebug);
+	CHECK_EQ(fake_heap_bytes(), 0);
+}
+
+
+int main(void){
+	RUN(test_first_frame_in_budget);
+	RUN(test_debug_window_opens);
+
+	if(fake_check_failures){
+		printf("%u checks failed\n", fake_check_failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,1101 @@
+/*
+ * test_timr.c
+ *
+ * Runs the app on the host against the fakes in fake_pebble.c: press the
+ * buttons, let simulated seconds pass, then check every vibe, redraw and
+ * write it made.
+ */
+
+#include <pebble.h>
+
+#include "check.h"
+#include "Timr.h"
+#include "Settings.h"
+#include "TimerCore.h"
+#include "Agenda.h"
+#include "Presets.h"
+#include "IconCache.h"
+#include "SessionLog.h"
+#include "Presenter.h"
+#include "TimerWindow.h"
+#include "WorkerProtocol.h"
+
+// Timr.c and TimrWorker.c are built with their mains renamed
+int timr_main(void);
+int worker_main(void);
+
+#define SECOND 1000
+#define MINUTE (60 * SECOND)
+
+// Where the countdown started on the fake clock
+static int64_t s_start_ms;
+
+// Counts at some point of a scenario, to compare against later
+static FakeCounts s_before;
+
+static void startTimer(){
+	fake_press(BUTTON_ID_UP);
+	s_start_ms = fake_now_ms();
+}
+
+// Seconds left when a vibe started
+static int64_t vibeRemaining(uint32_t vibe, uint16_t start_time){
+	return start_time - (fake_vibes[vibe].time_ms - s_start_ms) / SECOND;
+}
+
+static void checkVibe(uint32_t vibe, int64_t at_ms, uint32_t num_segments, uint32_t first_duration){
+	CHECK_EQ(fake_vibes[vibe].time_ms - s_start_ms, at_ms);
+	CHECK_EQ(fake_vibes[vibe].num_segments, num_segments);
+	CHECK_EQ(fake_vibes[vibe].durations[0], first_duration);
+}
+
+
+// Minutes on the timer window. DigitLayer.c keeps the digit values first in
+// its data, 10 for a blank.
+static int shownMinutes(){
+	Layer *digits = fake_layer_child(window_get_root_layer(fake_top_window()), 1);
+	const uint8_t *values = layer_get_data(digits);
+	return (values[0] == 10 ? 0 : values[0] * 10) + values[1];
+}
+
+static bool secondsShown(){
+	Layer *digits = fake_layer_child(window_get_root_layer(fake_top_window()), 1);
+	const uint8_t *values = layer_get_data(digits);
+	return values[3] != 10;
+}
+
+static bool ticking(){
+	TimeUnits unit;
+	return fake_ticks_subscribed(&unit) && unit == SECOND_UNIT;
+}
+
+static void tenMinuteTalk(){
+	settings_set(TIMER_START_TIME, 10 * 60);
+	fake_press(BUTTON_ID_SELECT);
+	fake_press(BUTTON_ID_BACK);
+	startTimer();
+}
+
+
+/*
+	Launch and exit
+	========================================================================================
+*/
+static void idle(){
+	fake_render();
+	CHECK_EQ(fake_stack_size(), 1);
+	CHECK(!fake_ticks_subscribed(NULL));
+
+	// The icons load once and are drawn, then nothing wakes or draws while stopped
+	fake_advance_ms(10 * MINUTE);
+	CHECK_EQ(fake_counts.timer_fires, 1);
+	CHECK(fake_render() > 0);
+
+	fake_advance_ms(10 * MINUTE);
+	CHECK_EQ(fake_counts.wakeups, 1);
+	CHECK_EQ(fake_counts.ticks, 0);
+	CHECK_EQ(fake_timers_pending(), 0);
+	CHECK_EQ(fake_render(), 0);
+}
+
+// A launch with the default settings and nothing running writes nothing
+static void test_launch_and_exit_writes_nothing(){
+	fake_run(timr_main, idle);
+
+	CHECK_EQ(fake_counts.persist_writes, 0);
+	CHECK_EQ(fake_counts.vibes, 0);
+	CHECK_EQ(fake_counts.wakeups_scheduled, 0);
+	CHECK_EQ(fake_heap_bytes(), 0);
+}
+
+
+/*
+	Countdown
+	========================================================================================
+*/
+static void fiveMinutes(){
+	// Start half way between two wall clock seconds
+	fake_advance_ms(500);
+	startTimer();
+	fake_advance_ms(5 * MINUTE + SECOND);
+
+	// Interval cues every 30 seconds, strong this close to the end
+	CHECK_EQ(fake_counts.vibes, 11);
+	for(uint32_t i = 0; i < 7; i++)
+		checkVibe(i, (i + 1) * 30 * SECOND, 1, 250);
+
+	checkVibe(7, 4 * MINUTE, 3, 200);
+	checkVibe(8, 4 * MINUTE + 30 * SECOND, 1, 250);
+	checkVibe(9, 4 * MINUTE + 50 * SECOND, 5, 100);
+	checkVibe(10, 5 * MINUTE, 5, 600);
+
+	CHECK_EQ(vibeRemaining(9, 300), 10);
+
+	// Counting up past zero, woken once a minute rather than ticking
+	CHECK(timer_core_get()->overtime);
+	CHECK(!fake_ticks_subscribed(NULL));
+	CHECK_EQ(fake_timers_pending(), 1);
+}
+
+// Every cue of the default 5:00 talk, each on the exact millisecond it is due
+static void test_five_minutes_cues_on_time(){
+	fake_run(timr_main, fiveMinutes);
+	CHECK_EQ(fake_counts.vibes, 11);
+}
+
+static void warningOnLastTen(){
+	settings_set(TIMER_START_TIME, 60);
+	settings_set(FINAL_WARNING_TIME, 10);
+	fake_press(BUTTON_ID_SELECT);
+	fake_press(BUTTON_ID_BACK);
+
+	startTimer();
+	fake_advance_ms(MINUTE);
+
+	// Interval, the final warning a second early, last ten, time up
+	CHECK_EQ(fake_counts.vibes, 4);
+	checkVibe(0, 30 * SECOND, 1, 250);
+	checkVibe(1, 49 * SECOND, 3, 200);
+	checkVibe(2, 50 * SECOND, 5, 100);
+	checkVibe(3, 60 * SECOND, 5, 600);
+}
+
+// A final warning set to the last ten seconds still plays, just before them
+static void test_final_warning_on_last_ten(){
+	fake_run(timr_main, warningOnLastTen);
+}
+
+static void pauseAfterTen(){
+	fake_render();
+	startTimer();
+	fake_advance_ms(10 * SECOND);
+	fake_press(BUTTON_ID_UP);
+	fake_render();
+
+	s_before = fake_counts;
+	fake_advance_ms(10 * MINUTE);
+
+	// Nothing ticks, wakes or draws while paused
+	CHECK(!fake_ticks_subscribed(NULL));
+	CHECK_EQ(fake_timers_pending(), 0);
+	CHECK_EQ(fake_counts.wakeups, s_before.wakeups);
+	CHECK_EQ(fake_counts.vibes, s_before.vibes);
+	CHECK_EQ(fake_render(), 0);
+	CHECK_EQ(timer_core_get()->time, 290);
+
+	// The first cue is still 20 seconds of running away
+	fake_press(BUTTON_ID_UP);
+	s_start_ms = fake_now_ms() - 10 * SECOND;
+	fake_advance_ms(20 * SECOND + 500);
+	CHECK_EQ(fake_counts.vibes, 1);
+	checkVibe(0, 30 * SECOND, 1, 250);
+}
+
+static void test_pause_sleeps(){
+	fake_run(timr_main, pauseAfterTen);
+}
+
+static void overtime(){
+	startTimer();
+	fake_advance_ms(5 * MINUTE + SECOND);
+	s_before = fake_counts;
+
+	// Counts up from zero, a cue for every whole minute past it. It only wakes
+	// on those, so the time is as of the last one.
+	CHECK(timer_core_get()->overtime);
+	CHECK(timer_core_get()->running);
+	fake_advance_ms(3 * MINUTE);
+	CHECK_EQ(timer_core_get()->overtime_time, 3 * 60);
+	CHECK_EQ(shownMinutes(), 3);
+	CHECK_EQ(fake_counts.vibes - s_before.vibes, 3);
+	for(uint32_t i = 0; i < 3; i++)
+		checkVibe(s_before.vibes + i, (6 + i) * MINUTE, 5, 400);
+
+	// Nothing to pause, up acknowledges it and goes back to the start
+	fake_press(BUTTON_ID_UP);
+	CHECK(!timer_core_get()->overtime);
+	CHECK(!timer_core_get()->running);
+	CHECK_EQ(timer_core_get()->time, 300);
+	CHECK_EQ(shownMinutes(), 5);
+
+	s_before = fake_counts;
+	fake_advance_ms(10 * MINUTE);
+	CHECK_EQ(fake_timers_pending(), 0);
+	CHECK_EQ(fake_counts.vibes, s_before.vibes);
+}
+
+static void overtimeRunsOut(){
+	startTimer();
+	fake_advance_ms(5 * MINUTE + SECOND);
+	s_before = fake_counts;
+
+	// Stopped once OVERTIME_MAX is passed, the display only has two minute digits
+	fake_advance_ms((int64_t) (OVERTIME_MAX - 60) * SECOND);
+	CHECK(timer_core_get()->overtime);
+	fake_advance_ms(2 * MINUTE);
+	CHECK(!timer_core_get()->overtime);
+	CHECK(!timer_core_get()->running);
+	CHECK_EQ(timer_core_get()->time, 300);
+	CHECK_EQ(fake_counts.vibes - s_before.vibes, OVERTIME_MAX / OVERTIME_CUE_TIME);
+
+	// And sleeps from then on
+	s_before = fake_counts;
+	fake_advance_ms(10 * MINUTE);
+	CHECK_EQ(fake_timers_pending(), 0);
+	CHECK_EQ(fake_counts.wakeups, s_before.wakeups);
+}
+
+// Past zero the timer counts up with an overtime cue every minute, until it is
+// acknowledged or OVERTIME_MAX runs out
+static void test_overtime_counts_up(){
+	fake_run(timr_main, overtime);
+	fake_reset(true);
+	fake_run(timr_main, overtimeRunsOut);
+}
+
+static void startPauseRestartStop(){
+	startTimer();
+	fake_advance_ms(31 * SECOND);
+	fake_press(BUTTON_ID_UP);
+	fake_advance_ms(5 * SECOND);
+	fake_press(BUTTON_ID_UP);
+	fake_advance_ms(SECOND);
+	fake_press(BUTTON_ID_DOWN);
+	fake_press(BUTTON_ID_SELECT);
+}
+
+static void checkRecord(const SessionRecord *record, SessionEvent event, uint8_t detail, uint16_t value){
+	CHECK_EQ(record->event, event);
+	CHECK_EQ(record->detail, detail);
+	CHECK_EQ(record->value, value);
+}
+
+// The core only keeps time, its subscribers play and log what it did
+static void test_session_logged_from_events(){
+	SessionRecord records[SESSION_RECORDS_PER_BLOCK];
+
+	fake_run(timr_main, startPauseRestartStop);
+	CHECK_EQ(fake_counts.vibes, 1);
+	CHECK(fake_persist_get(SESSION_LOG_BLOCK, records, sizeof(records)));
+
+	checkRecord(&records[0], SESSION_START, 0, 300);
+	checkRecord(&records[1], SESSION_CUE, CUE_INTERVAL, 270);
+	checkRecord(&records[2], SESSION_PAUSE, 0, 269);
+	checkRecord(&records[3], SESSION_RESUME, 0, 269);
+	checkRecord(&records[4], SESSION_RESTART, 0, 268);
+	checkRecord(&records[5], SESSION_STOP, 0, 300);
+	CHECK_EQ(records[6].time, 0);
+}
+
+static void longTalk(){
+	settings_set(TIMER_START_TIME, 30 * 60);
+	fake_press(BUTTON_ID_SELECT);
+	fake_press(BUTTON_ID_BACK);
+	fake_advance_ms(SECOND);
+	fake_render();
+
+	startTimer();
+	fake_render();
+	s_before = fake_counts;
+	fake_advance_ms(10 * MINUTE);
+
+	// Minutes only: a wake at every interval cue, the minute changes land on
+	// cues too. Nothing ticks.
+	CHECK_EQ(fake_counts.ticks, s_before.ticks);
+	CHECK_EQ(fake_counts.wakeups - s_before.wakeups, 20);
+	CHECK_EQ(fake_counts.vibes - s_before.vibes, 20);
+	CHECK_EQ(timer_core_get()->time, 20 * 60);
+}
+
+static void lastHour(){
+	settings_set(TIMER_START_TIME, 59 * 60 + 30);
+	fake_press(BUTTON_ID_SELECT);
+	fake_press(BUTTON_ID_BACK);
+	CHECK_EQ(shownMinutes(), 59);
+
+	// Minutes only, rounded up
+	startTimer();
+	fake_advance_ms(SECOND);
+	CHECK_EQ(shownMinutes(), 60);
+	fake_advance_ms(29 * SECOND);
+	CHECK_EQ(shownMinutes(), 59);
+	fake_advance_ms(MINUTE);
+	CHECK_EQ(shownMinutes(), 58);
+}
+
+// Close to an hour the rounded up minutes go past 59 instead of wrapping to 0
+static void test_minutes_round_up_past_the_hour(){
+	fake_run(timr_main, lastHour);
+}
+
+// A long talk wakes for its cues and minutes, not every second
+static void test_long_talk_wakes_for_cues_only(){
+	fake_run(timr_main, longTalk);
+}
+
+
+static void lowBattery(){
+	fake_set_battery(LOW_BATTERY_PERCENT, false);
+	tenMinuteTalk();
+
+	// Past SECONDS_TIME the seconds stay off, nothing ticks
+	fake_advance_ms(5 * MINUTE + SECOND);
+	CHECK(!secondsShown());
+	CHECK(!ticking());
+
+	// Until the final warning
+	fake_advance_ms(4 * MINUTE - 2 * SECOND);
+	CHECK(!secondsShown());
+	fake_advance_ms(2 * SECOND);
+	CHECK(secondsShown());
+	CHECK(ticking());
+}
+
+static void charging(){
+	fake_set_battery(LOW_BATTERY_PERCENT, false);
+	tenMinuteTalk();
+	fake_advance_ms(6 * MINUTE);
+	CHECK(!ticking());
+
+	// Plugged in it isn't low any more
+	fake_set_battery(LOW_BATTERY_PERCENT, true);
+	CHECK(secondsShown());
+	CHECK(ticking());
+}
+
+// Low on battery the seconds only come on for the final warning
+static void test_low_battery_hides_seconds(){
+	fake_run(timr_main, lowBattery);
+	fake_reset(true);
+	fake_run(timr_main, charging);
+}
+
+static void peek(){
+	tenMinuteTalk();
+	fake_advance_ms(MINUTE);
+	CHECK(!secondsShown());
+	CHECK(!ticking());
+
+	// A tap shows the seconds, ticking while they are up
+	fake_tap();
+	CHECK(secondsShown());
+	CHECK(ticking());
+
+	// Another tap starts the peek over
+	fake_advance_ms(PEEK_TIME_MS / 2);
+	fake_tap();
+	fake_advance_ms(PEEK_TIME_MS - SECOND);
+	CHECK(secondsShown());
+	CHECK(ticking());
+
+	// Then back to minutes: the peek ending and the two interval cues wake it,
+	// the minute changes on a cue
+	s_before = fake_counts;
+	fake_advance_ms(SECOND);
+	CHECK(!secondsShown());
+	CHECK(!ticking());
+	fake_advance_ms(MINUTE);
+	CHECK_EQ(fake_counts.ticks, s_before.ticks);
+	CHECK_EQ(fake_counts.wakeups - s_before.wakeups, 3);
+}
+
+// A tap shows the seconds for PEEK_TIME_MS, then the minutes only come back
+static void test_tap_peeks_at_seconds(){
+	fake_run(timr_main, peek);
+}
+
+
+/*
+	Menu and settings
+	========================================================================================
+*/
+static void editStartTime(){
+	// Timer, then Set Time, the first row of the menu
+	fake_press(BUTTON_ID_SELECT);
+	fake_menu_click(0, 0);
+	CHECK_EQ(fake_stack_size(), 3);
+
+	// Three minutes up, one back down
+	fake_press(BUTTON_ID_UP);
+	fake_press(BUTTON_ID_UP);
+	fake_press(BUTTON_ID_UP);
+	fake_press(BUTTON_ID_DOWN);
+
+	// Nothing is written until the timer shows again
+	fake_press(BUTTON_ID_BACK);
+	CHECK_EQ(fake_counts.persist_writes, 0);
+	fake_press(BUTTON_ID_BACK);
+
+	CHECK_EQ(fake_stack_size(), 1);
+	CHECK_EQ(fake_counts.persist_writes, 1);
+	CHECK_EQ(timer_core_get()->timer_start_time, 7 * 60);
+	CHECK_EQ(timer_core_get()->time, 7 * 60);
+}
+
+static void reopenWindows(){
+	// The first trip creates the menu and Set Time windows
+	fake_press(BUTTON_ID_SELECT);
+	fake_menu_click(0, 0);
+	fake_press(BUTTON_ID_BACK);
+	fake_press(BUTTON_ID_BACK);
+	fake_advance_ms(SECOND);
+	size_t heap = fake_heap_bytes();
+	s_before = fake_counts;
+
+	// Every trip after that reuses them
+	for(int i = 0; i < 50; i++){
+		fake_press(BUTTON_ID_SELECT);
+		fake_menu_click(0, 0);
+		CHECK_EQ(fake_stack_size(), 3);
+		fake_render();
+		fake_press(BUTTON_ID_BACK);
+		fake_press(BUTTON_ID_BACK);
+		CHECK_EQ(fake_stack_size(), 1);
+		CHECK_EQ(fake_heap_bytes(), heap);
+	}
+
+	CHECK_EQ(fake_counts.window_pushes - s_before.window_pushes, 100);
+	CHECK_EQ(fake_counts.window_pops - s_before.window_pops, 100);
+	CHECK_EQ(fake_counts.heap_high_water, s_before.heap_high_water);
+}
+
+// Windows are built once, going in and out of them many times allocates nothing
+static void test_windows_reused(){
+	fake_run(timr_main, reopenWindows);
+	CHECK_EQ(fake_heap_bytes(), 0);
+}
+
+// Shared icons load once, the last release frees them. Run here rather than
+// in a launch, the cache works the same outside a window.
+static void test_icons_refcounted(){
+	GBitmap *play = icon_cache_acquire(RESOURCE_ID_IMAGE_PLAY2);
+	CHECK(play != NULL);
+	CHECK(icon_cache_acquire(RESOURCE_ID_IMAGE_PLAY2) == play);
+	CHECK_EQ(fake_counts.bitmap_loads, 1);
+	size_t bytes = icon_cache_heap_bytes();
+	size_t heap = fake_heap_bytes();
+	CHECK(bytes > 0);
+
+	icon_cache_release(RESOURCE_ID_IMAGE_PLAY2);
+	CHECK_EQ(icon_cache_heap_bytes(), bytes);
+	CHECK_EQ(fake_heap_bytes(), heap);
+	icon_cache_release(RESOURCE_ID_IMAGE_PLAY2);
+	CHECK_EQ(icon_cache_heap_bytes(), 0);
+	CHECK_EQ(fake_heap_bytes(), 0);
+
+	// Loaded again after that, a release too many does nothing
+	CHECK(icon_cache_acquire(RESOURCE_ID_IMAGE_PLAY2) != NULL);
+	CHECK_EQ(fake_counts.bitmap_loads, 2);
+	icon_cache_release(RESOURCE_ID_IMAGE_PLAY2);
+	icon_cache_release(RESOURCE_ID_IMAGE_PLAY2);
+	CHECK_EQ(fake_heap_bytes(), 0);
+
+	// Full, the next distinct icon isn't loaded
+	for(uint32_t id = 100; id < 100 + ICON_CACHE_SIZE; id++)
+		CHECK(icon_cache_acquire(id) != NULL);
+	CHECK(icon_cache_acquire(100 + ICON_CACHE_SIZE) == NULL);
+	CHECK_EQ(fake_counts.bitmap_loads, 2 + ICON_CACHE_SIZE);
+	for(uint32_t id = 100; id < 100 + ICON_CACHE_SIZE; id++)
+		icon_cache_release(id);
+	CHECK_EQ(fake_heap_bytes(), 0);
+}
+
+static void iconsOnce(){
+	fake_advance_ms(SECOND);
+	for(int i = 0; i < 5; i++){
+		fake_press(BUTTON_ID_SELECT);
+		fake_menu_click(0, 0);
+		fake_press(BUTTON_ID_BACK);
+		fake_press(BUTTON_ID_BACK);
+		fake_advance_ms(SECOND);
+	}
+
+	// Four on the timer window, three on Set Time, none of them shared
+	CHECK_EQ(fake_counts.bitmap_loads, 7);
+}
+
+// Windows keep their icons while they are kept, they load once a launch
+static void test_icons_load_once(){
+	fake_run(timr_main, iconsOnce);
+	CHECK_EQ(fake_heap_bytes(), 0);
+}
+
+static void checkSevenMinutes(){
+	CHECK_EQ(settings_get()->timer_start_time, 7 * 60);
+	CHECK_EQ(timer_core_get()->time, 7 * 60);
+}
+
+// An edit is written once, and is still there next launch
+static void test_set_time_written_once(){
+	fake_run(timr_main, editStartTime);
+	CHECK_EQ(fake_counts.persist_writes, 1);
+
+	fake_reset(false);
+	fake_run(timr_main, checkSevenMinutes);
+	CHECK_EQ(fake_counts.persist_writes, 0);
+}
+
+static void pickPreset(){
+	// Timer, then Talk, the second preset
+	fake_press(BUTTON_ID_SELECT);
+	fake_render();
+	CHECK_STR(fake_menu_title(1, 1), "Talk");
+	fake_menu_click(1, 1);
+	fake_press(BUTTON_ID_BACK);
+
+	const Preset *preset = preset_get(2);
+	CHECK_EQ(settings_get()->preset, 2);
+	CHECK_EQ(timer_core_get()->timer_start_time, preset->timer_start_time);
+	CHECK_EQ(timer_core_get()->interval_time, preset->interval_time);
+	CHECK_EQ(timer_core_get()->final_warning_time, preset->final_warning_time);
+	CHECK_EQ(shownMinutes(), 20);
+
+	// Set Time left as it was keeps the preset
+	fake_press(BUTTON_ID_SELECT);
+	fake_menu_click(0, 0);
+	fake_press(BUTTON_ID_BACK);
+	CHECK_EQ(settings_get()->preset, 2);
+
+	// A changed time takes over from it
+	fake_menu_click(0, 0);
+	fake_press(BUTTON_ID_UP);
+	fake_press(BUTTON_ID_BACK);
+	fake_press(BUTTON_ID_BACK);
+	CHECK_EQ(settings_get()->preset, PRESET_NONE);
+	CHECK_EQ(timer_core_get()->timer_start_time, DEFAULT_TIMER_START_TIME + 60);
+	CHECK_EQ(timer_core_get()->interval_time, DEFAULT_INTERVAL_TIME);
+	CHECK_EQ(timer_core_get()->final_warning_time, DEFAULT_FINAL_WARNING_TIME);
+}
+
+// A preset brings its own times, until one of them is edited
+static void test_preset_times_until_edited(){
+	fake_run(timr_main, pickPreset);
+}
+
+// Counts the timer events it hears about
+static int s_events_heard;
+
+static void eventsHeardA(TimerEventType event){
+	if(event == TIMER_EVENT_STATE)
+		s_events_heard++;
+}
+
+static void eventsHeardB(TimerEventType event){
+}
+
+static void eventsHeardC(TimerEventType event){
+}
+
+static void timerSubscribers(){
+	// Subscribed again behind a free slot, it still hears each event once
+	CHECK(timer_core_subscribe(eventsHeardB));
+	CHECK(timer_core_subscribe(eventsHeardA));
+	timer_core_unsubscribe(eventsHeardB);
+	CHECK(timer_core_subscribe(eventsHeardA));
+
+	s_events_heard = 0;
+	startTimer();
+	CHECK_EQ(s_events_heard, 1);
+
+	// The app's four and A, one more fills it
+	CHECK(timer_core_subscribe(eventsHeardB));
+	CHECK(!timer_core_subscribe(eventsHeardC));
+}
+
+// Timer subscribers can't be registered twice, and a full table says so
+static void test_timer_subscribers(){
+	fake_run(timr_main, timerSubscribers);
+}
+
+// Counts the settings changes it hears about
+static int s_settings_heard;
+
+static void settingsHeardA(const TimrSettings *settings){
+	s_settings_heard++;
+}
+
+static void settingsHeardB(const TimrSettings *settings){
+}
+
+static void settingsHeardC(const TimrSettings *settings){
+}
+
+static void settingsHeardD(const TimrSettings *settings){
+}
+
+static void settingsSubscribers(){
+	// Subscribed again behind a free slot, it still hears each change once
+	CHECK(settings_subscribe(settingsHeardB));
+	CHECK(settings_subscribe(settingsHeardA));
+	settings_unsubscribe(settingsHeardB);
+	CHECK(settings_subscribe(settingsHeardA));
+
+	s_settings_heard = 0;
+	settings_set(TIMER_START_TIME, 10 * 60);
+	CHECK_EQ(s_settings_heard, 1);
+
+	// TimerCore and A, then two more fill it
+	CHECK(settings_subscribe(settingsHeardB));
+	CHECK(settings_subscribe(settingsHeardC));
+	CHECK(!settings_subscribe(settingsHeardD));
+}
+
+// Settings subscribers can't be registered twice, and a full table says so
+static void test_settings_subscribers(){
+	fake_run(timr_main, settingsSubscribers);
+}
+
+// A settings record as version 1 wrote it, before presets
+typedef struct __attribute__((__packed__)) {
+	uint8_t version;
+	uint8_t checksum;
+	uint16_t timer_start_time;
+	uint16_t interval_time;
+	uint16_t final_warning_time;
+	uint16_t agenda;
+	uint32_t write_count;
+} RecordV1;
+
+// Version 2 adds the preset, one byte on the end
+#define RECORD_V2_LENGTH (sizeof(RecordV1) + 1)
+
+// Same sum as Storage.c, over every byte after the checksum
+static uint8_t recordChecksum(const uint8_t *bytes, size_t length){
+	uint8_t sum = 0;
+	for(size_t i = 2; i < length; i++)
+		sum = (sum << 1 | sum >> 7) ^ bytes[i];
+	return sum;
+}
+
+static void storeLegacyKeys(){
+	int32_t start_time = 10 * 60, interval_time = 60;
+	fake_persist_set(LEGACY_TIMER_START_TIME, &start_time, sizeof(start_time));
+	fake_persist_set(LEGACY_INTERVAL_TIME, &interval_time, sizeof(interval_time));
+}
+
+static void checkMigrated(){
+	CHECK_EQ(settings_get()->timer_start_time, 10 * 60);
+	CHECK_EQ(settings_get()->interval_time, 60);
+	CHECK_EQ(settings_get()->final_warning_time, DEFAULT_FINAL_WARNING_TIME);
+	CHECK_EQ(timer_core_get()->time, 10 * 60);
+}
+
+// The one key per setting layout is stored as a record, and only then deleted
+static void test_legacy_keys_migrated(){
+	int32_t value;
+	storeLegacyKeys();
+
+	// Nothing can be written, so nothing is deleted either
+	fake_set_storage_full(true);
+	fake_run(timr_main, checkMigrated);
+	CHECK(fake_persist_get(LEGACY_TIMER_START_TIME, &value, sizeof(value)));
+	CHECK(fake_persist_get(LEGACY_INTERVAL_TIME, &value, sizeof(value)));
+
+	fake_reset(false);
+	fake_run(timr_main, checkMigrated);
+	CHECK(!fake_persist_get(LEGACY_TIMER_START_TIME, &value, sizeof(value)));
+	CHECK(!fake_persist_get(LEGACY_INTERVAL_TIME, &value, sizeof(value)));
+
+	// The record alone carries them from now on
+	fake_reset(false);
+	fake_run(timr_main, checkMigrated);
+	CHECK_EQ(fake_counts.persist_writes, 0);
+}
+
+static void checkVersion1(){
+	CHECK_EQ(settings_get()->timer_start_time, 8 * 60);
+	CHECK_EQ(settings_get()->interval_time, 2 * 60);
+	CHECK_EQ(settings_get()->preset, DEFAULT_PRESET_SELECTED);
+}
+
+// A version 1 record loads as it is and is written back as version 2
+static void test_version_1_record_upgraded(){
+	RecordV1 old = {
+		.version = 1,
+		.timer_start_time = 8 * 60,
+		.interval_time = 2 * 60,
+		.final_warning_time = 60,
+		.agenda = 0,
+		.write_count = 7
+	};
+	old.checksum = recordChecksum((const uint8_t *) &old, sizeof(old));
+	fake_persist_set(SETTINGS_RECORD, &old, sizeof(old));
+
+	fake_run(timr_main, checkVersion1);
+	CHECK_EQ(fake_counts.persist_writes, 1);
+
+	uint8_t bytes[RECORD_V2_LENGTH + 1] = { 0 };
+	CHECK(fake_persist_get(SETTINGS_RECORD, bytes, sizeof(bytes)));
+	RecordV1 stored;
+	memcpy(&stored, bytes, sizeof(stored));
+	CHECK_EQ(stored.version, 2);
+	CHECK_EQ(stored.checksum, recordChecksum(bytes, RECORD_V2_LENGTH));
+	CHECK_EQ(stored.write_count, 8);
+	CHECK_EQ(bytes[sizeof(RecordV1)], DEFAULT_PRESET_SELECTED);
+
+	// Read back as version 2, nothing left to write
+	fake_reset(false);
+	fake_run(timr_main, checkVersion1);
+	CHECK_EQ(fake_counts.persist_writes, 0);
+}
+
+static void holdUp(){
+	fake_press(BUTTON_ID_SELECT);
+	fake_menu_click(0, 0);
+
+	// 5 one minute steps, 10 of five minutes, then ten minutes at a time
+	fake_hold(BUTTON_ID_UP, 5);
+	fake_press(BUTTON_ID_BACK);
+	CHECK_EQ(settings_get()->timer_start_time, 10 * 60);
+
+	fake_menu_click(0, 0);
+	fake_hold(BUTTON_ID_UP, 15);
+	fake_press(BUTTON_ID_BACK);
+	CHECK_EQ(settings_get()->timer_start_time, 60 * 60 - 1);
+}
+
+// Holding a button steps further the longer it is held
+static void test_held_button_accelerates(){
+	fake_run(timr_main, holdUp);
+}
+
+
+/*
+	Agendas
+	========================================================================================
+*/
+static void agendaMenu(){
+	fake_press(BUTTON_ID_SELECT);
+	fake_render();
+
+	// The built in agendas, each with its segments
+	CHECK_STR(fake_menu_title(2, 1), "Talk + Q&A");
+	CHECK_STR(fake_menu_subtitle(2, 1), "Talk, Q&A");
+	CHECK_STR(fake_menu_subtitle(2, 2), "Intro, Demo, Q&A");
+
+	// Picking one starts its first segment
+	fake_menu_click(2, 2);
+	fake_press(BUTTON_ID_BACK);
+	CHECK_EQ(timer_core_get()->timer_start_time, 300);
+	CHECK_EQ(timer_core_get()->segment, 0);
+
+	// Intro runs into the demo
+	fake_press(BUTTON_ID_UP);
+	fake_advance_ms(5 * MINUTE + SECOND);
+	CHECK_EQ(timer_core_get()->segment, 1);
+	CHECK_EQ(timer_core_get()->timer_start_time, 1800);
+}
+
+// Agendas that don't fit what the app can run are never used
+static void test_bad_agendas_fall_back(){
+	AgendaBook book = { .version = AGENDA_VERSION, .num_agendas = 1 };
+	strcpy(book.agendas[0].name, "Broken");
+
+	// More segments than fit
+	book.agendas[0].num_segments = AGENDA_MAX_SEGMENTS + 1;
+	fake_persist_set(AGENDA_BOOK, &book, sizeof(book));
+	fake_run(timr_main, agendaMenu);
+
+	// None at all
+	fake_reset(true);
+	book.agendas[0].num_segments = 0;
+	fake_persist_set(AGENDA_BOOK, &book, sizeof(book));
+	fake_run(timr_main, agendaMenu);
+
+	// Cut short
+	fake_reset(true);
+	book.agendas[0].num_segments = 1;
+	book.agendas[0].segments[0].duration = 5 * 60;
+	fake_persist_set(AGENDA_BOOK, &book, sizeof(book) - 1);
+	fake_run(timr_main, agendaMenu);
+
+	// Longer than the display shows, or no time at all
+	fake_reset(true);
+	book.agendas[0].segments[0].duration = AGENDA_MAX_DURATION + 1;
+	fake_persist_set(AGENDA_BOOK, &book, sizeof(book));
+	fake_run(timr_main, agendaMenu);
+
+	fake_reset(true);
+	book.agendas[0].segments[0].duration = 0;
+	fake_persist_set(AGENDA_BOOK, &book, sizeof(book));
+	fake_run(timr_main, agendaMenu);
+}
+
+
+/*
+	Background
+	========================================================================================
+*/
+static void exitRunning(){
+	fake_advance_ms(500);
+	startTimer();
+	fake_advance_ms(10 * SECOND);
+}
+
+// A cue launch shows the timer while the pattern plays, and closes once it has
+static void cuePlaysOut(){
+	const FakeVibe *vibe = &fake_vibes[fake_counts.vibes - 1];
+	int64_t ends_ms = vibe->time_ms;
+	for(uint32_t i = 0; i < vibe->num_segments; i++)
+		ends_ms += vibe->durations[i];
+
+	fake_advance_ms(ends_ms - fake_now_ms() - 1);
+	CHECK_EQ(fake_stack_size(), 1);
+	fake_advance_ms(1);
+	CHECK_EQ(fake_stack_size(), 0);
+}
+
+// exitRunning() starts the countdown half a second in
+#define EXIT_START_MS ((int64_t) FAKE_EPOCH * SECOND + 500)
+
+// Closed while running, the next cue is handed to the system, which relaunches
+// the app just to play it. It closes again once the pattern has played, scheduling the next.
+static void test_exit_running_schedules_wakeup(){
+	fake_run(timr_main, exitRunning);
+
+	// The end time, and the session log
+	CHECK_EQ(fake_counts.persist_writes, 3);
+	CHECK_EQ(fake_counts.worker_launches, 0);
+	CHECK_EQ(fake_num_wakeups, 1);
+	CHECK_EQ(fake_wakeups[0].time, FAKE_EPOCH + 31);
+	CHECK_EQ(fake_heap_bytes(), 0);
+
+	int32_t cookie = fake_wakeups[0].cookie;
+	fake_advance_ms((int64_t) fake_wakeups[0].time * SECOND - fake_now_ms());
+	fake_set_launch(APP_LAUNCH_WAKEUP, cookie);
+	s_before = fake_counts;
+	fake_run(timr_main, cuePlaysOut);
+
+	CHECK_EQ(fake_counts.vibes, 1);
+	CHECK_EQ(fake_vibes[0].num_segments, 1);
+	CHECK_EQ(fake_vibes[0].durations[0], 250);
+	CHECK_EQ(fake_counts.window_pushes - s_before.window_pushes, 1);
+
+	// The stored countdown is unchanged, only the cue goes in the session log
+	CHECK_EQ(fake_counts.persist_writes - s_before.persist_writes, 2);
+	CHECK_EQ(fake_num_wakeups, 1);
+	CHECK_EQ(fake_wakeups[0].time, FAKE_EPOCH + 61);
+	CHECK_EQ(fake_heap_bytes(), 0);
+}
+
+// The worker carries on from where the app closed, to the end and past it
+static void workerRunsTalk(){
+	fake_advance_ms(5 * MINUTE);
+}
+
+// With the wakeups taken the worker holds the cues, it opens the app at each
+// one on time and sleeps in between
+static void test_worker_wakes_for_cues_only(){
+	fake_set_wakeups_available(false);
+	fake_run(timr_main, exitRunning);
+	CHECK_EQ(fake_counts.worker_launches, 1);
+	CHECK_EQ(fake_num_wakeups, 0);
+
+	uint32_t wakeups = fake_counts.wakeups;
+	fake_run(worker_main, workerRunsTalk);
+	wakeups = fake_counts.wakeups - wakeups;
+
+	// Seven intervals from 4:30, the final warning, 0:30, the last ten and time up
+	CHECK_EQ(fake_counts.app_launches, 11);
+	CHECK_EQ(fake_app_launches[0] - EXIT_START_MS, 30 * SECOND);
+	CHECK_EQ(fake_app_launches[7] - EXIT_START_MS, 4 * MINUTE);
+	CHECK_EQ(fake_app_launches[10] - EXIT_START_MS, 5 * MINUTE);
+	CHECK_EQ(wakeups, 11);
+}
+
+// Opened by the worker, the app plays the cue due and closes, leaving the worker and storage be
+static void test_worker_cue_plays_and_closes(){
+	fake_set_wakeups_available(false);
+	fake_run(timr_main, exitRunning);
+
+	// The final warning, with the launch trailing it a little
+	fake_advance_ms(EXIT_START_MS + 4 * MINUTE + 300 - fake_now_ms());
+	fake_set_launch(APP_LAUNCH_WORKER, 0);
+	s_before = fake_counts;
+	fake_run(timr_main, cuePlaysOut);
+
+	CHECK_EQ(fake_counts.vibes, 1);
+	CHECK_EQ(fake_vibes[0].num_segments, 3);
+	CHECK_EQ(fake_vibes[0].durations[0], 200);
+	CHECK_EQ(fake_counts.window_pushes - s_before.window_pushes, 1);
+
+	CHECK(app_worker_is_running());
+	CHECK_EQ(fake_counts.worker_launches, s_before.worker_launches);
+	CHECK_EQ(fake_counts.worker_messages, s_before.worker_messages);
+	CHECK_EQ(fake_counts.persist_writes - s_before.persist_writes, 2);
+	CHECK_EQ(fake_num_wakeups, 0);
+}
+
+static void workerRunsDemo(){
+	fake_advance_ms(10 * MINUTE);
+}
+
+static void exitRunningAgenda(){
+	fake_press(BUTTON_ID_SELECT);
+	fake_menu_click(2, 2);
+	fake_press(BUTTON_ID_BACK);
+	exitRunning();
+}
+
+// Intro's time up opens the app, which moves on to the demo. The worker still
+// running has only Intro's cues, so it is told to reload and carries on with the demo's.
+static void test_worker_chains_segments(){
+	fake_set_wakeups_available(false);
+	fake_run(timr_main, exitRunningAgenda);
+	CHECK_EQ(fake_counts.worker_launches, 1);
+
+	fake_run(worker_main, workerRunsTalk);
+	CHECK_EQ(fake_app_launches[fake_counts.app_launches - 1] - EXIT_START_MS, 5 * MINUTE);
+
+	fake_set_launch(APP_LAUNCH_WORKER, 0);
+	s_before = fake_counts;
+	fake_run(timr_main, NULL);
+
+	BackgroundState state;
+	CHECK(fake_persist_get(BACKGROUND_END_TIME, &state, sizeof(state)));
+	CHECK_EQ(state.segment, 1);
+	CHECK_EQ(state.timer_start_time, 1800);
+	CHECK_EQ(state.end_ms - EXIT_START_MS, 35 * MINUTE);
+	CHECK(app_worker_is_running());
+	CHECK_EQ(fake_counts.worker_launches, s_before.worker_launches);
+	CHECK_EQ(fake_counts.worker_messages - s_before.worker_messages, 1);
+
+	// Reloaded, the first of the demo's cues is its 20:00 interval
+	s_before = fake_counts;
+	fake_run(worker_main, workerRunsDemo);
+	CHECK_EQ(fake_counts.app_launches - s_before.app_launches, 1);
+	CHECK_EQ(fake_app_launches[s_before.app_launches] - EXIT_START_MS, 15 * MINUTE);
+}
+
+
+
+/*
+	Phone
+	========================================================================================
+*/
+// Value of key in a message, or fallback when it wasn't sent
+static int32_t messageValue(const FakeMessage *message, uint32_t key, int32_t fallback){
+	for(uint8_t i = 0; i < message->num_keys; i++){
+		if(message->keys[i] == key)
+			return message->values[i];
+	}
+	return fallback;
+}
+
+// Each launch adds 50 records, numbered on from the ones before. The launch
+// is a process of its own, so the test tells it which one it is.
+#define FILL_RECORDS 50
+static uint16_t s_fill_launch;
+
+static void fillLog(){
+	for(int i = 0; i < FILL_RECORDS; i++)
+		session_log_add(SESSION_CUE, CUE_INTERVAL, s_fill_launch * FILL_RECORDS + i);
+}
+
+static void sendLog(){
+	fake_press(BUTTON_ID_SELECT);
+	fake_menu_click(0, 3);
+	fake_advance_ms(10 * SECOND);
+}
+
+// A full log goes to the phone oldest first, SESSION_LOG_BATCH records a message
+static void test_session_log_exported_in_batches(){
+	// More than fit, the oldest are dropped
+	for(s_fill_launch = 0; s_fill_launch < 3; s_fill_launch++){
+		fake_reset(false);
+		fake_run(timr_main, fillLog);
+	}
+
+	fake_reset(false);
+	fake_run(timr_main, sendLog);
+
+	// Presenter messages go out too, only the log's are counted
+	uint16_t oldest = 3 * FILL_RECORDS - SESSION_LOG_CAPACITY;
+	uint16_t batches = 0;
+	for(uint32_t i = 0; i < fake_counts.messages; i++){
+		const FakeMessage *message = &fake_messages[i];
+		if(messageValue(message, KEY_LOG_TOTAL, -1) < 0)
+			continue;
+
+		CHECK_EQ(messageValue(message, KEY_LOG_TOTAL, -1), SESSION_LOG_CAPACITY);
+		CHECK_EQ(messageValue(message, KEY_LOG_OFFSET, -1), batches * SESSION_LOG_BATCH);
+		CHECK_EQ(messageValue(message, KEY_LOG_RECORDS, -1), SESSION_LOG_BATCH * sizeof(SessionRecord));
+
+		const SessionRecord *records = (const SessionRecord *) message->data;
+		for(int j = 0; j < SESSION_LOG_BATCH; j++){
+			CHECK_EQ(records[j].event, SESSION_CUE);
+			CHECK_EQ(records[j].value, oldest + batches * SESSION_LOG_BATCH + j);
+		}
+		batches++;
+	}
+	CHECK_EQ(batches, SESSION_LOG_CAPACITY / SESSION_LOG_BATCH);
+}
+
+static void phoneAway(){
+	// Out of range from the start, what the launch sent is lost
+	fake_set_connected(false);
+	startTimer();
+	fake_advance_ms(10 * MINUTE);
+
+	// Tried again less and less often, not on every failure
+	CHECK(fake_counts.messages >= 5);
+	CHECK(fake_counts.messages <= 20);
+
+	// Back in range, the next try gets the whole state through
+	fake_set_connected(true);
+	s_before = fake_counts;
+	fake_advance_ms(PRESENTER_RETRY_MAX_MS + SECOND);
+	CHECK_EQ(fake_counts.messages - s_before.messages, 1);
+
+	const FakeMessage *message = &fake_messages[fake_counts.messages - 1];
+	CHECK_EQ(messageValue(message, KEY_PRESENTER_STATE, -1), PRESENTER_RUNNING);
+	CHECK_EQ(messageValue(message, KEY_PRESENTER_SEGMENT, -1), 0);
+	CHECK_EQ(messageValue(message, KEY_PRESENTER_TOTAL, -1), 300);
+
+	// Delivered, nothing more until the timer changes
+	s_before = fake_counts;
+	fake_advance_ms(5 * MINUTE);
+	CHECK_EQ(fake_counts.messages, s_before.messages);
+}
+
+// A message the phone never got is sent again once it is back in range
+static void test_presenter_resends_after_failure(){
+	fake_run(timr_main, phoneAway);
+}
+
+
+int main(void){
+	RUN(test_launch_and_exit_writes_nothing);
+	RUN(test_five_minutes_cues_on_time);
+	RUN(test_final_warning_on_last_ten);
+	RUN(test_pause_sleeps);
+	RUN(test_overtime_counts_up);
+	RUN(test_session_logged_from_events);
+	RUN(test_minutes_round_up_past_the_hour);
+	RUN(test_long_talk_wakes_for_cues_only);
+	RUN(test_low_battery_hides_seconds);
+	RUN(test_tap_peeks_at_seconds);
+	RUN(test_set_time_written_once);
+	RUN(test_settings_subscribers);
+	RUN(test_timer_subscribers);
+	RUN(test_windows_reused);
+	RUN(test_icons_refcounted);
+	RUN(test_icons_load_once);
+	RUN(test_preset_times_until_edited);
+	RUN(test_legacy_keys_migrated);
+	RUN(test_version_1_record_upgraded);
+	RUN(test_held_button_accelerates);
+	RUN(test_bad_agendas_fall_back);
+	RUN(test_exit_running_schedules_wakeup);
+	RUN(test_worker_wakes_for_cues_only);
+	RUN(test_worker_cue_plays_and_closes);
+	RUN(test_worker_chains_segments);
+	RUN(test_presenter_resends_after_failure);
+	RUN(test_session_log_exported_in_batches);
+
+	if(fake_check_failures){
+		printf("%u checks failed\n", fake_check_failures);
+		return 1;
+	}
+	return 0;
+}
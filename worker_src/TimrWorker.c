@@ -0,0 +1,86 @@
+#include <pebble_worker.h>
+
+#include "../src/Timr.h"
+#include "../src/WorkerProtocol.h"
+#include "../src/Countdown.h"
+#include "../src/Cues.h"
+
+/*
+	Variables
+	========================================================================================
+*/
+// The countdown the app left and its segment's cues, built from storage when the worker starts
+static Countdown s_countdown;
+static CueTimeline s_timeline;
+
+// Fires at the next cue, NULL when there is none
+static AppTimer *s_timer;
+
+
+/*
+	Logic and Operations
+	========================================================================================
+*/
+static void cue_handler(void *data);
+
+// Sleep until the next cue is due, nothing wakes the worker in between
+static void scheduleNextCue(){
+	if(s_timer){
+		app_timer_cancel(s_timer);
+		s_timer = NULL;
+	}
+	
+	if(!s_countdown.running)
+		return;
+	
+	int32_t ms = cues_ms_until_next(&s_timeline, countdown_remaining_ms(&s_countdown));
+	if(ms >= 0)
+		s_timer = app_timer_register(ms, cue_handler, NULL);
+}
+
+// Vibration isn't available to workers, so a cue launches the app to play it.
+// The app works out which cue from the clock and closes again once it has played.
+static void cue_handler(void *data){
+	s_timer = NULL;
+	
+	if(cues_advance(&s_timeline, countdown_remaining(&s_countdown)) != CUE_NONE)
+		worker_launch_app();
+	
+	scheduleNextCue();
+}
+
+// Pick up what the app stored when it closed, skipping cues already passed
+static void loadState(){
+	BackgroundState state;
+	
+	s_countdown.running = persist_read_data(BACKGROUND_END_TIME, &state, sizeof(state)) == sizeof(state);
+	if(s_countdown.running){
+		s_countdown.end_ms = state.end_ms;
+		cues_build(&s_timeline, state.timer_start_time, state.interval_time, state.final_warning_time);
+		cues_seek(&s_timeline, countdown_remaining(&s_countdown));
+	}
+	
+	scheduleNextCue();
+}
+
+static void message_handler(uint16_t type, AppWorkerMessage *data){
+	if(type == WORKER_RELOAD)
+		loadState();
+}
+
+
+/*
+	Worker Initiation
+	========================================================================================
+*/
+int main(void) {
+	loadState();
+	app_worker_message_subscribe(message_handler);
+	
+	worker_event_loop();
+	
+	app_worker_message_unsubscribe();
+	if(s_timer)
+		app_timer_cancel(s_timer);
+	return 0;
+}